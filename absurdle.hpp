@@ -0,0 +1,270 @@
+#pragma once
+
+#include "wordle.hpp"
+
+// Absurdle, where the host has no hidden word, and instead answers each guess with the result shared by the
+// most remaining answers, which are the only answers it keeps
+//
+// the host is deterministic, so a strategy is a single line of guesses rather than a tree
+// depth(S) = 1 if S is one answer, otherwise 1 + min over guesses g of depth(B), for the bucket B the host
+// keeps, found by iterative deepening with the bounds proven for each set kept in a transposition table
+// ties go to the bucket which is not the guess itself, then to the lowest result code, so the host only gives
+// a win once it is the last answer
+
+// longest line searched for
+#define ABSURDLE_MAX_DEPTH 32u
+
+// fewest guesses which force a win from a set of answers, and the first guess of a line which does so
+// `depth` is exact if `exact`, otherwise a lower bound
+struct AbsurdleEntry
+{
+    uint8_t depth;
+    bool exact;
+    uint16_t word;
+};
+
+// proven bounds, keyed by the fingerprint of the answer set, which can be shared between threads
+class AbsurdleMemo
+{
+public:
+    bool find(const Fingerprint &key, AbsurdleEntry &entry) const
+    {
+        return table.find(key, entry);
+    }
+
+    // exact depths replace bounds, and bounds only ever increase
+    void insert(const Fingerprint &key, const AbsurdleEntry &entry)
+    {
+        table.insert(key, entry,
+                     [](AbsurdleEntry &current, const AbsurdleEntry &entry)
+                     {
+                         if (not current.exact and (entry.exact or entry.depth > current.depth))
+                             current = entry;
+                     });
+    }
+
+    FlatCache<Fingerprint, AbsurdleEntry, FingerprintHash> table;
+};
+
+static AbsurdleMemo ABSURDLE_MEMO;
+
+// lower bound on the depth of n answers
+// a guess has at most N_PATTERNS results, so the host keeps at least 1 / N_PATTERNS of the answers
+template <uint8_t L>
+uint8_t absurdle_lower_bound(size_t n)
+{
+    uint8_t depth = 1;
+    for (; n > 1; n = (n + N_PATTERNS<L> - 1) / N_PATTERNS<L>)
+        ++depth;
+    return depth;
+}
+
+// bucket the host keeps after a guess, as its result code and size
+// counts must be zero for every code, and are left that way
+template <uint8_t L>
+std::pair<uint32_t, uint32_t> host_bucket(const std::vector<uint16_t> &answers, uint16_t word,
+                                          uint16_t *counts)
+{
+    const Code<L> *row = &PATTERNS<L>[(size_t)word * N_VALID];
+
+    // counts only increase, so the bucket ahead after its last answer is ahead overall
+    uint32_t best = WIN<L>, size = 0;
+    for (const auto &answer : answers)
+    {
+        const uint32_t code = row[answer];
+        const uint32_t count = ++counts[code];
+        if (count > size or (count == size and (best == WIN<L> or (code != WIN<L> and code < best))))
+            best = code, size = count;
+    }
+
+    for (const auto &answer : answers)
+        counts[row[answer]] = 0;
+    return {best, size};
+}
+
+// whether a guess gives every answer a different result, leaving the host one answer which is not the guess
+template <uint8_t L>
+bool separates(const std::vector<uint16_t> &answers, uint16_t word, uint16_t *counts)
+{
+    const Code<L> *row = &PATTERNS<L>[(size_t)word * N_VALID];
+
+    size_t k = 0;
+    while (k < answers.size() and not counts[row[answers[k]]]++)
+        ++k;
+
+    for (size_t j = 0; j < answers.size() and j <= k; ++j)
+        counts[row[answers[j]]] = 0;
+    return k == answers.size();
+}
+
+template <uint8_t L>
+bool solve_absurdle(const std::vector<uint16_t> &answers, uint8_t depth, uint16_t &word);
+
+// whether some guess forces a win in exactly `depth` guesses, from at least two answers which need more than
+// depth - 1, setting word to the first such guess
+template <uint8_t L>
+bool search_absurdle(const std::vector<uint16_t> &answers, uint8_t depth, uint16_t &word)
+{
+    const uint32_t n = (uint32_t)answers.size();
+
+    // every bucket must hold a single answer, so the first guess which separates them all
+    if (depth == 2)
+    {
+        std::atomic<uint32_t> first{N_WORDS};
+        POOL.parallel_for(N_WORDS, 64,
+                          [&](unsigned, uint32_t start, uint32_t end)
+                          {
+                              std::vector<uint16_t> counts(N_PATTERNS<L>, 0);
+                              for (uint32_t i = start; i < end and i < first; ++i)
+                                  if (separates<L>(answers, (uint16_t)i, counts.data()))
+                                  {
+                                      uint32_t current = first;
+                                      while (i < current and not first.compare_exchange_weak(current, i))
+                                          ;
+                                      break;
+                                  }
+                          });
+
+        word = (uint16_t)first;
+        return first < N_WORDS;
+    }
+
+    // the bucket each guess leaves, skipping guesses which leave everything or too much to finish in time
+    struct Candidate
+    {
+        uint32_t size;
+        uint16_t word;
+        uint32_t code;
+
+        bool operator<(const Candidate &other) const
+        {
+            return (size != other.size) ? size < other.size : word < other.word;
+        }
+    };
+
+    std::vector<Candidate> candidates(N_WORDS);
+    POOL.parallel_for(N_WORDS, 64,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          std::vector<uint16_t> counts(N_PATTERNS<L>, 0);
+                          for (uint32_t i = start; i < end; ++i)
+                          {
+                              const auto bucket = host_bucket<L>(answers, (uint16_t)i, counts.data());
+                              candidates[i] = {bucket.second, (uint16_t)i, bucket.first};
+                          }
+                      });
+
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](const Candidate &candidate) {
+                                        return candidate.size == n or
+                                               absurdle_lower_bound<L>(candidate.size) >= depth;
+                                    }),
+                     candidates.end());
+
+    // smallest buckets first, in parallel at the top of the search
+    // the line found is the first in order which succeeds, whichever thread finds it
+    std::sort(candidates.begin(), candidates.end());
+    std::atomic<uint32_t> first{U32MAX};
+    POOL.parallel_for((uint32_t)candidates.size(), 1,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          for (uint32_t r = start; r < end and r < first; ++r)
+                          {
+                              const Candidate &candidate = candidates[r];
+                              const Code<L> *row = &PATTERNS<L>[(size_t)candidate.word * N_VALID];
+
+                              std::vector<uint16_t> bucket;
+                              bucket.reserve(candidate.size);
+                              for (const auto &answer : answers)
+                                  if (row[answer] == candidate.code)
+                                      bucket.push_back(answer);
+
+                              uint16_t next;
+                              if (solve_absurdle<L>(bucket, (uint8_t)(depth - 1), next))
+                              {
+                                  uint32_t current = first;
+                                  while (r < current and not first.compare_exchange_weak(current, r))
+                                      ;
+                                  break;
+                              }
+                          }
+                      });
+
+    if (first == U32MAX)
+        return false;
+
+    word = candidates[first].word;
+    return true;
+}
+
+// whether the host can be forced to give a win within `depth` guesses from the answers
+// if so, sets word to the first guess of a shortest line
+template <uint8_t L>
+bool solve_absurdle(const std::vector<uint16_t> &answers, uint8_t depth, uint16_t &word)
+{
+    if (answers.size() == 1)
+    {
+        word = ANSWER_GUESS[answers[0]];
+        return true;
+    }
+
+    const Fingerprint key = fingerprint(answers.data(), answers.size() * sizeof(uint16_t));
+    AbsurdleEntry entry = {absurdle_lower_bound<L>(answers.size()), false, 0};
+    ABSURDLE_MEMO.find(key, entry);
+
+    // deepen from the best known bound, so the line found is always a shortest one
+    while (not entry.exact and entry.depth <= depth)
+    {
+        if (search_absurdle<L>(answers, entry.depth, entry.word))
+            entry.exact = true;
+        else
+            ++entry.depth;
+        ABSURDLE_MEMO.insert(key, entry);
+    }
+
+    if (not entry.exact or entry.depth > depth)
+        return false;
+
+    word = entry.word;
+    return true;
+}
+
+// find and print a shortest line which forces the host to give a win, after any opening guesses
+// each guess is shown with the result the host gives and the number of answers it keeps
+// returns the number of guesses in the line, or 0 if none was found within ABSURDLE_MAX_DEPTH
+template <uint8_t L>
+uint32_t evaluate_absurdle(const std::vector<uint16_t> &opening = {})
+{
+    std::vector<uint16_t> answers(N_VALID);
+    std::iota(answers.begin(), answers.end(), 0);
+
+    std::vector<uint16_t> counts(N_PATTERNS<L>, 0);
+    Results result[L];
+    uint32_t j = 0;
+    for (bool r = true; r; ++j)
+    {
+        uint16_t index;
+        if (j < opening.size())
+            index = opening[j];
+        else if (j >= ABSURDLE_MAX_DEPTH or
+                 not solve_absurdle<L>(answers, (uint8_t)(ABSURDLE_MAX_DEPTH - j), index))
+        {
+            std::cout << "No line found within " << ABSURDLE_MAX_DEPTH << " guesses" << std::endl;
+            return 0;
+        }
+
+        const uint32_t code = host_bucket<L>(answers, index, counts.data()).first;
+        const Code<L> *row = &PATTERNS<L>[(size_t)index * N_VALID];
+        answers.erase(std::remove_if(answers.begin(), answers.end(),
+                                     [&](uint16_t answer) { return row[answer] != code; }),
+                      answers.end());
+
+        r = code != WIN<L>;
+        decode<L>(result, code);
+        print_move<L>(std::cout, result, get_word(index));
+        std::cout << " " << answers.size() << std::endl;
+    }
+
+    std::cout << "Forced a win in " << j << " guesses" << std::endl;
+    return j;
+}
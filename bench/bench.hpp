@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// keep the compiler from optimizing away a result
+template <typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// time fn and print the result as one line of JSON
+// fn is repeated in batches of at least 10 ms, and the median batch is reported
+// `items` is the units of work done per call of fn, e.g., answers scored, for throughput
+template <typename F>
+void bench(const char *suite, const char *name, F &&fn, double items = 1, unsigned samples = 7)
+{
+    using clock = std::chrono::steady_clock;
+    const auto seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+    // warm up and pick a batch size
+    uint64_t batch = 1;
+    while (true)
+    {
+        const auto start = clock::now();
+        for (uint64_t i = 0; i < batch; ++i)
+            fn();
+
+        if (seconds(clock::now() - start) >= 0.01)
+            break;
+        batch *= 2;
+    }
+
+    std::vector<double> times;
+    for (unsigned s = 0; s < samples; ++s)
+    {
+        const auto start = clock::now();
+        for (uint64_t i = 0; i < batch; ++i)
+            fn();
+        times.push_back(seconds(clock::now() - start) / (double)batch);
+    }
+
+    std::sort(times.begin(), times.end());
+    const double median = times[times.size() / 2];
+
+    printf("{\"suite\": \"%s\", \"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.1f, "
+           "\"min_ns_per_op\": %.1f, \"ops_per_sec\": %.1f, \"items_per_op\": %.0f, \"items_per_sec\": %.1f}\n",
+           suite, name, (unsigned long)(batch * samples), median * 1e9, times[0] * 1e9, 1 / median, items,
+           items / median);
+    fflush(stdout);
+}
@@ -0,0 +1,48 @@
+#include "mathler.hpp"
+#include "bench/bench.hpp"
+
+#define VALUE 12  // value used for all benchmarks
+
+int main()
+{
+    bench("mathler", "build_expressions", []() { build_expressions(); }, 1, 3);
+    bench("mathler", "populate_expressions", []() { keep(populate_expressions(VALUE)); });
+
+    Context context(VALUE);
+    const Expressions &exps = context.exps;
+    const char *guess = exps[0];
+    const char *hidden = exps[exps.size / 2];
+
+    Results result[L];
+    play(result, guess, hidden);
+
+    const std::vector<uint16_t> all = all_answers(exps);
+    State after;
+    after.apply(result, guess);
+
+    bench("mathler", "play", [&]() {
+        for (uint16_t j = 0; j < exps.size; ++j)
+        {
+            play(result, guess, exps[j]);
+            keep(result);
+        }
+    }, exps.size);
+
+    bench("mathler", "state_apply", [&]() {
+        State state;
+        state.apply(result, guess);
+        keep(state);
+    });
+
+    const PackedAnswers packed(exps, all);
+    bench("mathler", "state_num_answers", [&]() { keep(after.num_answers(packed)); }, exps.size);
+
+    bench("mathler", "find_guess_cold", [&]() {
+        context.guess_cache.clear();
+        keep(find_guess(context, State(), all));
+    }, exps.size, 3);
+
+    bench("mathler", "evaluate", []() { keep(evaluate(VALUE, false, false)); }, exps.size, 3);
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include "absurdle.hpp"
+#include "tree.hpp"
+#include "wordle.hpp"
+#include "bench/bench.hpp"
+
+// the benchmarks use the standard five letter lists
+constexpr uint8_t L = 5;
+
+// stated limits of the decision tree, which fail the benchmark when exceeded
+#define TREE_MAX_BYTES_PER_NODE 16.0  // image size over node count, including the header
+#define TREE_MAX_P99_LOOKUP_US 1.0    // 99th percentile time to play one answer's game from the root
+
+int main()
+{
+    if (not initialize<L>())
+        return 1;
+
+    const char *guess = get_word(ANSWER_GUESS[0]);
+    const char *hidden = get_valid_word(N_VALID / 2);
+
+    Results result[L];
+    play<L>(result, guess, hidden);
+
+    State<L> after;
+    after.apply(result, guess);
+    const AnswerSet all = AnswerSet::all();
+
+    bench("wordle", "play", [&]() {
+        for (uint16_t j = 0; j < N_VALID; ++j)
+        {
+            play<L>(result, guess, get_valid_word(j));
+            keep(result);
+        }
+    }, N_VALID);
+
+    std::vector<Code<L>> codes(N_VALID);
+    bench("wordle", "play_all", [&]() {
+        PLAY_ALL<L>(codes.data(), guess);
+        keep(codes[0]);
+    }, N_VALID);
+
+    bench("wordle", "populate_patterns", []() { populate_patterns<L>(); }, (double)N_WORDS * N_VALID);
+
+    bench("wordle", "state_apply", [&]() {
+        State<L> state;
+        state.apply(result, guess);
+        keep(state);
+    });
+
+    bench("wordle", "state_num_answers", [&]() { keep(after.num_answers(all)); });
+
+    bench("wordle", "find_guess_cold", [&]() {
+        guess_cache.clear();
+        keep(find_guess(State<L>(), all));
+    }, N_WORDS);
+
+    // the same search, stopped after 5 ms
+    DEADLINE_MS = 5;
+    bench("wordle", "find_guess_deadline", [&]() {
+        guess_cache.clear();
+        keep(find_guess(State<L>(), all));
+    }, N_WORDS);
+    DEADLINE_MS = 0;
+
+    // first guess under each strategy
+    std::vector<uint16_t> answers(N_VALID);
+    std::iota(answers.begin(), answers.end(), 0);
+    bench("wordle", "best_guess_expected", [&]() { keep(best_guess<L, EXPECTED>(answers)); }, N_WORDS);
+    bench("wordle", "best_guess_minimax", [&]() { keep(best_guess<L, MINIMAX>(answers)); }, N_WORDS);
+    bench("wordle", "best_guess_entropy", [&]() { keep(best_guess<L, ENTROPY>(answers)); }, N_WORDS);
+
+    // second guess, over every guess and over those allowed in hard mode
+    std::vector<uint16_t> remaining;
+    after.answers().for_each([&](uint16_t answer) { remaining.push_back(answer); });
+    const std::vector<uint16_t> legal = after.legal_guesses();
+    bench("wordle", "best_guess_second", [&]() { keep(best_guess<L, MINIMAX>(remaining)); }, N_WORDS);
+    bench("wordle", "best_guess_second_hard", [&]() { keep(best_guess<L, MINIMAX>(remaining, legal)); },
+          (double)legal.size());
+
+    // shortest forced line against the adversarial host, proving that no shorter line exists
+    bench("wordle", "absurdle_solve_cold", [&]() {
+        ABSURDLE_MEMO.table.clear();
+        uint16_t word;
+        keep(solve_absurdle<L>(answers, ABSURDLE_MAX_DEPTH, word));
+    }, 1, 3);
+
+    bench("wordle", "evaluate_cold", []() {
+        guess_cache.clear();
+        keep(evaluate<L>(false));
+    }, N_VALID, 3);
+
+    // the decision tree, checked against the search for every answer, and its size
+    const std::vector<char> image = build_tree<L>();
+    DecisionTree tree;
+    tree.open<L>(image.data(), image.size());
+
+    uint32_t depth = 0;
+    for (uint16_t j = 0; j < N_VALID; ++j)
+    {
+        State<L> state;
+        AnswerSet remaining = all;
+        uint32_t d = 1;
+        for (uint32_t node = tree.root();; ++d)
+        {
+            const uint16_t index = tree.guess(node);
+            if (index != find_guess(state, remaining))
+            {
+                fprintf(stderr, "tree disagrees with the search for %.*s\n", (int)L, get_valid_word(j));
+                return 1;
+            }
+
+            const uint32_t code = get_pattern<L>(index, j);
+            if (code == WIN<L>)
+                break;
+
+            decode<L>(result, code);
+            state.apply(result, get_word(index));
+            filter_answers(remaining, state, index, code);
+            node = tree.next(node, code);
+        }
+        depth = std::max(depth, d);
+    }
+
+    printf("{\"suite\": \"wordle\", \"name\": \"tree_size\", \"nodes\": %u, \"bytes\": %zu, "
+           "\"bytes_per_answer\": %.1f, \"max_depth\": %u}\n",
+           tree.count(), tree.bytes(), (double)tree.bytes() / N_VALID, depth);
+
+    // every answer's path from the root, computing each result as a client would
+    bench("wordle", "tree_lookup", [&]() {
+        for (uint16_t j = 0; j < N_VALID; ++j)
+        {
+            uint32_t node = tree.root(), code;
+            while ((code = get_pattern<L>(tree.guess(node), j)) != WIN<L>)
+                node = tree.next(node, code);
+            keep(node);
+        }
+    }, N_VALID);
+
+    // time each answer's game separately, repeated so the clock is a small part of it
+    const uint32_t repeats = 100;
+    std::vector<double> lookup_us(N_VALID);
+    for (uint16_t j = 0; j < N_VALID; ++j)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t k = 0; k < repeats; ++k)
+        {
+            uint32_t node = tree.root(), code;
+            while ((code = get_pattern<L>(tree.guess(node), j)) != WIN<L>)
+                node = tree.next(node, code);
+            keep(node);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        lookup_us[j] = std::chrono::duration<double, std::micro>(elapsed).count() / repeats;
+    }
+    std::sort(lookup_us.begin(), lookup_us.end());
+
+    const double bytes_per_node = (double)tree.bytes() / tree.count();
+    const double p99_us = lookup_us[(size_t)((double)(N_VALID - 1) * 0.99)];
+    printf("{\"suite\": \"wordle\", \"name\": \"tree_limits\", \"bytes_per_node\": %.2f, "
+           "\"max_bytes_per_node\": %.1f, \"p99_lookup_us\": %.4f, \"max_p99_lookup_us\": %.1f}\n",
+           bytes_per_node, TREE_MAX_BYTES_PER_NODE, p99_us, TREE_MAX_P99_LOOKUP_US);
+
+    if (bytes_per_node > TREE_MAX_BYTES_PER_NODE or p99_us > TREE_MAX_P99_LOOKUP_US)
+    {
+        fprintf(stderr, "decision tree exceeds its stated limits\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <random>
+
+#include "wordle.hpp"
+
+// multi-board games, such as Dordle, Quordle and Octordle
+//
+// every guess is played on all boards at once, each board has its own hidden word, and the game is won once
+// every board has been solved
+// given a guess the boards are independent, so a guess is scored by the sum over unsolved boards of the
+// expected number of answers left on each, from each board's own histogram of results
+// this grows with the sum of the boards' answers, rather than with the product of them
+
+#define MAX_BOARDS 8u
+
+// guesses allowed for n boards, as in the common variants
+inline uint8_t board_limit(uint8_t n)
+{
+    return (uint8_t)(n + 5);
+}
+
+template <uint8_t L>
+struct Board
+{
+    State<L> state;
+    AnswerSet answers = AnswerSet::all();
+    bool solved = false;
+};
+
+// best guesses found for sets of boards, keyed by the fingerprints of their answers
+static GuessCache board_cache;
+
+// fingerprint of the unsolved boards, in any order
+template <uint8_t L>
+Fingerprint boards_key(const std::vector<Board<L>> &boards)
+{
+    std::vector<Fingerprint> keys;
+    for (const auto &board : boards)
+        if (not board.solved)
+            keys.push_back(board.answers.fingerprint());
+
+    std::sort(keys.begin(), keys.end());
+    return fingerprint(keys.data(), keys.size() * sizeof(Fingerprint));
+}
+
+// best guess for the unsolved boards
+// the answers left on a board after a guess are those in its bucket, or none if the guess solves it
+// ties go to a guess which could solve a board, then the first guess
+template <uint8_t L>
+uint16_t find_board_guess(const std::vector<Board<L>> &boards)
+{
+    const Fingerprint key = boards_key(boards);
+    uint16_t cached;
+    if (board_cache.find(key, cached))
+        return cached;
+
+    std::vector<std::vector<uint16_t>> answers;
+    std::vector<bool> candidate(N_WORDS);
+    for (const auto &board : boards)
+        if (not board.solved)
+        {
+            answers.emplace_back();
+            board.answers.for_each(
+                [&](uint16_t answer)
+                {
+                    answers.back().push_back(answer);
+                    candidate[ANSWER_GUESS[answer]] = true;
+                });
+        }
+
+    // expected answers left on each board after each guess, scored in parallel across both
+    const uint32_t n_boards = (uint32_t)answers.size();
+    std::vector<double> costs((size_t)n_boards * N_WORDS);
+    POOL.parallel_for(n_boards * N_WORDS, 64,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          uint16_t counts[N_PATTERNS<L>] = {};
+                          for (uint32_t k = start; k < end; ++k)
+                          {
+                              const std::vector<uint16_t> &board = answers[k / N_WORDS];
+                              const Code<L> *row = &PATTERNS<L>[(size_t)(k % N_WORDS) * N_VALID];
+
+                              // sum of squared bucket sizes, without the guess itself, which leaves no
+                              // answers
+                              uint64_t sum = 0;
+                              for (const auto &answer : board)
+                                  if (row[answer] != WIN<L>)
+                                      sum += 2u * counts[row[answer]]++ + 1;  // (n + 1)^2 - n^2
+                              for (const auto &answer : board)
+                                  counts[row[answer]] = 0;
+
+                              costs[k] = (double)sum / (double)board.size();
+                          }
+                      });
+
+    uint16_t best = 0;
+    double best_cost = std::numeric_limits<double>::max();
+    for (uint16_t i = 0; i < N_WORDS; ++i)
+    {
+        double cost = 0;
+        for (uint32_t b = 0; b < n_boards; ++b)
+            cost += costs[(size_t)b * N_WORDS + i];
+
+        if (cost < best_cost or (cost == best_cost and candidate[i] and not candidate[best]))
+        {
+            best = i;
+            best_cost = cost;
+        }
+    }
+
+    board_cache.insert(key, best);
+    return best;
+}
+
+// play one guess on every unsolved board, returning the number of boards it solved
+template <uint8_t L>
+uint8_t play_boards(std::vector<Board<L>> &boards, uint16_t index, const uint16_t *hidden)
+{
+    Results result[L];
+    uint8_t solved = 0;
+    for (size_t b = 0; b < boards.size(); ++b)
+    {
+        Board<L> &board = boards[b];
+        if (board.solved)
+            continue;
+
+        const uint32_t code = get_pattern<L>(index, hidden[b]);
+        decode<L>(result, code);
+        board.state.apply(result, get_word(index));
+        filter_answers(board.answers, board.state, index, code);
+        solved += (board.solved = code == WIN<L>);
+    }
+    return solved;
+}
+
+// play `games` games of n boards, with hidden words drawn at random from a fixed seed
+// prints each game's guesses and the number of guesses it took, then the number of games taking each number
+// of guesses, with the games left unsolved last
+// returns the average number of guesses
+template <uint8_t L>
+float evaluate_boards(uint8_t n, uint32_t games, bool verbose = true)
+{
+    const uint8_t limit = board_limit(n);
+
+    std::mt19937 rng(n);
+    std::uniform_int_distribution<uint32_t> random_answer(0, N_VALID - 1u);
+    std::vector<uint16_t> hidden((size_t)games * n);
+    for (uint32_t g = 0; g < games; ++g)
+    {
+        // distinct words on the boards of a game
+        uint16_t *game = &hidden[(size_t)g * n];
+        for (uint8_t b = 0; b < n; ++b)
+            do
+                game[b] = (uint16_t)random_answer(rng);
+            while (std::find(game, game + b, game[b]) != game + b);
+    }
+
+    // search the first guess across all threads before games start sharing them
+    find_board_guess(std::vector<Board<L>>(n));
+
+    std::vector<std::string> traces(games);
+    std::vector<uint8_t> guesses(games);
+    POOL.parallel_for(games, 1,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          for (uint32_t g = start; g < end; ++g)
+                          {
+                              std::vector<Board<L>> boards(n);
+                              std::ostringstream out;
+
+                              uint8_t j = 0, solved = 0;
+                              for (; j < limit and solved < n; ++j)
+                              {
+                                  const uint16_t index = find_board_guess(boards);
+                                  solved += play_boards(boards, index, &hidden[(size_t)g * n]);
+                                  out.write(get_word(index), L) << " ";
+                              }
+
+                              j = (uint8_t)(j + (solved < n));
+                              out << (int)j;
+                              for (uint8_t b = 0; b < n; ++b)
+                              {
+                                  const char *word = get_valid_word(hidden[(size_t)g * n + b]);
+                                  (out << ((b) ? "," : " ")).write(word, L);
+                              }
+
+                              traces[g] = out.str();
+                              guesses[g] = j;
+                          }
+                      });
+
+    float avg = 0;
+    std::vector<uint32_t> totals(limit + 1u);
+    for (uint32_t g = 0; g < games; ++g)
+    {
+        if (verbose)
+            std::cout << traces[g] << std::endl;
+        totals[guesses[g] - 1]++;
+        avg += (float)guesses[g];
+    }
+
+    avg /= (float)games;
+    if (verbose)
+    {
+        for (const auto &total : totals)
+            std::cout << total << " ";
+        std::cout << "Avg: " << avg << std::endl;
+    }
+
+    return avg;
+}
+
+// play the boards with the given hidden words, showing the result on each board after every guess
+template <uint8_t L>
+void check_boards(const std::vector<uint16_t> &hidden)
+{
+    const uint8_t n = (uint8_t)hidden.size();
+    std::vector<Board<L>> boards(n);
+
+    uint8_t solved = 0;
+    for (uint8_t j = 0; j < board_limit(n) and solved < n; ++j)
+    {
+        const uint16_t index = find_board_guess(boards);
+        const char *guess = get_word(index);
+
+        Results result[L];
+        for (uint8_t b = 0; b < n; ++b)
+        {
+            if (boards[b].solved)
+                std::cout << std::string(L, ' ');
+            else
+            {
+                decode<L>(result, get_pattern<L>(index, hidden[b]));
+                print_move<L>(std::cout, result, guess);
+            }
+            std::cout << ((b + 1 < n) ? "  " : "\n");
+        }
+
+        solved += play_boards(boards, index, hidden.data());
+    }
+
+    std::cout << ((solved == n) ? "Solved" : "Not solved") << std::endl;
+}
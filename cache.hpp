@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// mix the bits of a word, so that every input bit affects every output bit (the splitmix64 finalizer)
+inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// hash of n 32-bit words, mixed two at a time
+inline uint64_t hash_words(const uint32_t *words, size_t n, uint64_t hash = 0)
+{
+    size_t i = 0;
+    for (; i + 1 < n; i += 2)
+        hash = mix64(hash ^ (words[i] | (uint64_t)words[i + 1] << 32));
+    if (i < n)
+        hash = mix64(hash ^ words[i]);
+    return hash;
+}
+
+// 128-bit fingerprint of a set, from two independently seeded hashes
+// collisions between the sets a solver visits are vanishingly unlikely, so it stands in for the set itself
+struct Fingerprint
+{
+    uint64_t lo = 0, hi = 0;
+
+    bool operator==(const Fingerprint &other) const
+    {
+        return lo == other.lo and hi == other.hi;
+    }
+
+    bool operator<(const Fingerprint &other) const
+    {
+        return (lo != other.lo) ? lo < other.lo : hi < other.hi;
+    }
+};
+
+inline Fingerprint fingerprint(const void *data, size_t bytes)
+{
+    Fingerprint r = {0x9e3779b97f4a7c15ull ^ bytes, 0xc2b2ae3d27d4eb4full ^ bytes};
+    for (size_t i = 0; i < bytes; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, (const char *)data + i, std::min(sizeof(uint64_t), bytes - i));
+        r.lo = mix64(r.lo ^ word);
+        r.hi = mix64(r.hi + (word << 32 | word >> 32));
+    }
+    return r;
+}
+
+// fingerprints are already well mixed
+struct FingerprintHash
+{
+    uint64_t operator()(const Fingerprint &key) const
+    {
+        return key.lo;
+    }
+};
+
+// counts kept by a FlatCache
+struct CacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;  // entries replaced to stay within the capacity
+    uint64_t entries = 0;
+    uint64_t slots = 0;
+};
+
+// hash table from keys to values, with open addressing, split into independently locked shards
+//
+// an entry sits in one of the PROBES slots following its hash, so a lookup reads one or two cache lines
+// unbounded tables double a shard once it is 3/4 full, or if all the slots for a new entry are taken
+// bounded tables never grow, and instead replace the least recently used entry among those slots
+template <typename K, typename V, typename Hash, unsigned N_SHARDS = 64>
+class FlatCache
+{
+public:
+    // capacity is the maximum number of entries, or 0 for no limit
+    // it is rounded up to a power of two slots per shard, of at least PROBES
+    explicit FlatCache(size_t capacity = 0)
+    {
+        set_capacity(capacity);
+    }
+
+    // drop every entry and set a new capacity
+    void set_capacity(size_t capacity)
+    {
+        size_t slots = (capacity) ? PROBES : MIN_SLOTS;
+        while (capacity and slots * N_SHARDS < capacity)
+            slots *= 2;
+
+        for (auto &s : shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.bounded = capacity != 0;
+            s.slots.assign(slots, {});
+            s.size = 0;
+        }
+    }
+
+    bool find(const K &key, V &value) const
+    {
+        const uint64_t hash = hash_of(key);
+        Shard &s = shard(hash);
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        Slot *slot = s.find(hash, key);
+        if (not slot)
+        {
+            ++s.stats.misses;
+            return false;
+        }
+
+        ++s.stats.hits;
+        slot->used = ++s.clock;
+        value = slot->value;
+        return true;
+    }
+
+    // add an entry, keeping any entry already present for the key
+    void insert(const K &key, const V &value)
+    {
+        insert(key, value, [](V &, const V &) {});
+    }
+
+    // add an entry, or call merge(current, value) on the entry already present for the key
+    template <typename F>
+    void insert(const K &key, const V &value, F &&merge)
+    {
+        const uint64_t hash = hash_of(key);
+        Shard &s = shard(hash);
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        if (Slot *slot = s.find(hash, key))
+        {
+            merge(slot->value, value);
+            slot->used = ++s.clock;
+            return;
+        }
+
+        ++s.stats.inserts;
+        if (not s.bounded and (s.size + 1) * 4 > s.slots.size() * 3)
+            s.grow();
+
+        Slot *slot;
+        while (not(slot = s.place(hash)))
+            s.grow();
+
+        s.size += not slot->hash;
+        *slot = {hash, key, value, ++s.clock};
+    }
+
+    // drop every entry, releasing the memory of unbounded tables
+    void clear()
+    {
+        for (auto &s : shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            std::vector<Slot>((s.bounded) ? s.slots.size() : MIN_SLOTS).swap(s.slots);
+            s.size = 0;
+        }
+    }
+
+    size_t size() const
+    {
+        size_t n = 0;
+        for (const auto &s : shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n += s.size;
+        }
+        return n;
+    }
+
+    CacheStats stats() const
+    {
+        CacheStats r;
+        for (const auto &s : shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            r.hits += s.stats.hits;
+            r.misses += s.stats.misses;
+            r.inserts += s.stats.inserts;
+            r.evictions += s.stats.evictions;
+            r.entries += s.size;
+            r.slots += s.slots.size();
+        }
+        return r;
+    }
+
+    // call fn(key, value) on every entry, must not run concurrently with insert()
+    template <typename F>
+    void for_each(F &&fn) const
+    {
+        for (const auto &s : shards)
+            for (const auto &slot : s.slots)
+                if (slot.hash)
+                    fn(slot.key, slot.value);
+    }
+
+private:
+    static constexpr size_t MIN_SLOTS = 16;
+    static constexpr size_t PROBES = 8;
+
+    struct Slot
+    {
+        uint64_t hash = 0;  // 0 if empty
+        K key;
+        V value;
+        uint64_t used = 0;  // clock of the last insert or hit
+    };
+
+    struct Shard
+    {
+        // slot holding key, or nullptr if not present
+        // entries are never removed, so the search stops at the first empty slot
+        Slot *find(uint64_t hash, const K &key)
+        {
+            const size_t mask = slots.size() - 1;
+            for (size_t i = 0; i < PROBES; ++i)
+            {
+                Slot &slot = slots[(hash + i) & mask];
+                if (not slot.hash)
+                    return nullptr;
+                if (slot.hash == hash and slot.key == key)
+                    return &slot;
+            }
+            return nullptr;
+        }
+
+        // slot for a new entry, either empty or the least recently used if bounded, or nullptr to grow
+        Slot *place(uint64_t hash)
+        {
+            const size_t mask = slots.size() - 1;
+            Slot *oldest = &slots[hash & mask];
+            for (size_t i = 0; i < PROBES; ++i)
+            {
+                Slot &slot = slots[(hash + i) & mask];
+                if (not slot.hash)
+                    return &slot;
+                if (slot.used < oldest->used)
+                    oldest = &slot;
+            }
+
+            if (not bounded)
+                return nullptr;
+
+            ++stats.evictions;
+            return oldest;
+        }
+
+        void grow()
+        {
+            std::vector<Slot> old(slots.size() * 2);
+            old.swap(slots);
+            for (const auto &slot : old)
+                if (slot.hash)
+                    *place_moved(slot.hash) = slot;
+        }
+
+        // empty slot for an entry moved by grow(), growing again in the rare case none are left
+        Slot *place_moved(uint64_t hash)
+        {
+            const size_t mask = slots.size() - 1;
+            for (size_t i = 0; i < PROBES; ++i)
+                if (not slots[(hash + i) & mask].hash)
+                    return &slots[(hash + i) & mask];
+
+            grow();
+            return place_moved(hash);
+        }
+
+        mutable std::mutex mutex;
+        std::vector<Slot> slots;
+        size_t size = 0;
+        uint64_t clock = 0;
+        bool bounded = false;
+        CacheStats stats;
+    };
+
+    // the low bits pick the slot, so the shard comes from the high bits
+    static uint64_t hash_of(const K &key)
+    {
+        return Hash()(key) | 1;
+    }
+
+    Shard &shard(uint64_t hash) const
+    {
+        return shards[(hash >> 40) % N_SHARDS];
+    }
+
+    mutable std::array<Shard, N_SHARDS> shards;
+};
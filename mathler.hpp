@@ -0,0 +1,580 @@
+#pragma once
+
+#include <cmath>
+#include <deque>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <array>
+
+#include "cache.hpp"
+#include "pool.hpp"
+
+// color codes
+#define BLK "\e[0;30m"
+#define GRN "\e[0;32m"
+#define YEL "\e[0;33m"
+#define RST "\e[0m"
+
+enum Results
+{
+    BLACK = 0,
+    YELLOW = 1,
+    GREEN = 2,
+};
+
+// result to color code
+static const char *COLOR[3] = {BLK, YEL, GRN};
+
+#define L 6
+
+#define NUMBERS 0x3FF0
+#define NO_ZERO 0x3FE0
+#define ALL_SYM 0x3FFF
+#define SYMMASK 0x000F
+
+enum Symbol
+{
+    // 0 - 9 are simply (1 - 10) + 4 (1 << 4 onward)
+    PLUS = 1 << 0,
+    MINUS = 1 << 1,
+    MULT = 1 << 2,
+    DIV = 1 << 3,
+};
+
+static char SYMBOLS[9] = {0, '+', '-', 0, '*', 0, 0, 0, '/'};
+
+inline uint16_t get_mask(char c)
+{
+    if ('0' <= c and c <= '9')
+        return (uint16_t)(1 << (c - '0' + 4));
+    else if (c == '+')
+        return PLUS;
+    else if (c == '-')
+        return MINUS;
+    else if (c == '*')
+        return MULT;
+    else if (c == '/')
+        return DIV;
+    return 0;
+}
+
+// the expressions equal to one value
+struct Expressions
+{
+    const char (*exps)[L] = nullptr;
+    std::array<const uint16_t *, L> masks = {};  // premasked symbols by position
+    const uint16_t *includes = nullptr;          // premasked expressions, every symbol of each
+    uint16_t size = 0;
+
+    const char *operator[](uint16_t i) const
+    {
+        return exps[i];
+    }
+};
+
+#define N_LANES 16u  // answers per vectorized count
+
+// masks of a list of answers, copied together so they can be scanned in order
+// padded to a multiple of N_LANES with empty masks, which no state allows
+struct PackedAnswers
+{
+    PackedAnswers(const Expressions &exps, const std::vector<uint16_t> &answers)
+    {
+        const size_t n = (answers.size() + N_LANES - 1) / N_LANES * N_LANES;
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            masks[i].assign(n, 0);
+            for (size_t k = 0; k < answers.size(); ++k)
+                masks[i][k] = exps.masks[i][answers[k]];
+        }
+
+        includes.assign(n, 0);
+        for (size_t k = 0; k < answers.size(); ++k)
+            includes[k] = exps.includes[answers[k]];
+    }
+
+    std::array<std::vector<uint16_t>, L> masks;
+    std::vector<uint16_t> includes;
+};
+
+// number of answers allowed by the valid and include masks of a state
+uint16_t count_valid_scalar(const uint32_t valid[L], uint32_t include, const PackedAnswers &answers)
+{
+    uint32_t k = 0;
+    for (size_t a = 0; a < answers.includes.size(); ++a)
+    {
+        bool r = not(include & ~(uint32_t)answers.includes[a]);
+        for (uint8_t i = 0; i < L; ++i)
+            r &= (valid[i] & answers.masks[i][a]) != 0;
+        k += r;
+    }
+    return (uint16_t)k;
+}
+
+#if defined(__x86_64__)
+// as count_valid_scalar, but for N_LANES answers at a time
+__attribute__((target("avx2"))) uint16_t count_valid_avx2(const uint32_t valid[L], uint32_t include,
+                                                          const PackedAnswers &answers)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i required = _mm256_set1_epi16((short)include);
+    __m256i allowed[L];
+    for (uint8_t i = 0; i < L; ++i)
+        allowed[i] = _mm256_set1_epi16((short)valid[i]);
+
+    uint32_t k = 0;
+    for (size_t a = 0; a < answers.includes.size(); a += N_LANES)
+    {
+        const __m256i includes = _mm256_loadu_si256((const __m256i *)&answers.includes[a]);
+        __m256i r = _mm256_cmpeq_epi16(_mm256_andnot_si256(includes, required), zero);
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            const __m256i masks = _mm256_loadu_si256((const __m256i *)&answers.masks[i][a]);
+            r = _mm256_andnot_si256(_mm256_cmpeq_epi16(_mm256_and_si256(masks, allowed[i]), zero), r);
+        }
+
+        // two bytes per allowed answer
+        k += (uint32_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(r)) / 2;
+    }
+    return (uint16_t)k;
+}
+#endif
+
+// count kernel for this machine, selected at startup
+using CountValid = uint16_t (*)(const uint32_t valid[L], uint32_t include, const PackedAnswers &answers);
+static const CountValid COUNT_VALID =
+#if defined(__x86_64__)
+    __builtin_cpu_supports("avx2") ? count_valid_avx2 :
+#endif
+                                   count_valid_scalar;
+
+// state which encodes known information
+// the remaining answers are kept separately, so that states are cheap to copy
+struct State
+{
+    std::array<uint32_t, L> valid = {NO_ZERO, ALL_SYM, ALL_SYM, ALL_SYM, ALL_SYM, NUMBERS};
+    uint32_t include = 0;  // values that must be included
+
+    bool operator==(const State &other) const
+    {
+        return include == other.include and valid == other.valid;
+    }
+
+    void apply(const Results result[L], const char *guess)
+    {
+        uint32_t temp = 0;
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            const uint16_t m = get_mask(guess[i]);
+            if (result[i] == GREEN)  // must be this value
+                valid[i] = m;
+
+            else if (result[i] == YELLOW)  // this position cannot be this value
+            {
+                valid[i] &= (uint16_t)~m;
+                include |= m;  // but this value must be elsewhere
+                temp |= m;     // keep track of prior yellow, as,
+            }
+            else
+            {
+                if (not(temp & m))  // if yellow of this letter not seen,
+                {
+                    for (uint8_t j = 0; j < L; ++j)  // no position can be this value
+                        if (valid[j] - m)            // there are other values, not just this one
+                            valid[j] &= (uint16_t)~m;
+                }
+                else  // else just this position is not this letter
+                    valid[i] &= (uint16_t)~m;
+            }
+        }
+    }
+
+    void print_mask(uint32_t mask) const
+    {
+        for (uint8_t j = 0; j < 10; ++j)
+            std::cout << ((mask & (1 << (j + 4))) ? (char)('0' + j) : '_');
+
+        for (const auto &symbol : {PLUS, MINUS, MULT, DIV})
+            std::cout << ((mask & symbol) ? SYMBOLS[symbol] : '_');
+
+        std::cout << std::endl;
+    }
+
+    void print(const Expressions &exps, const std::vector<uint16_t> &answers) const
+    {
+        std::cout << exps.size << " / " << answers.size() << std::endl;
+        print_mask(include);
+        for (uint8_t i = 0; i < L; ++i)
+            print_mask(valid[i]);
+    }
+
+    inline bool is_valid(const Expressions &exps, uint16_t index) const
+    {
+        bool r = not(include & ~(uint32_t)exps.includes[index]);
+        for (uint8_t i = 0; i < L; ++i)
+            r &= (valid[i] & exps.masks[i][index]) != 0;
+        return r;
+    }
+
+    void valid_answers(const Expressions &exps, std::vector<uint16_t> &answers) const
+    {
+        uint16_t j = 0;
+        for (const auto &answer : answers)
+            if (is_valid(exps, answer))
+                answers[j++] = answer;
+
+        answers.resize(j);
+    }
+
+    uint16_t num_answers(const PackedAnswers &answers) const
+    {
+        return COUNT_VALID(valid.data(), include, answers);
+    }
+};
+
+// every expression, the answers before any guess
+std::vector<uint16_t> all_answers(const Expressions &exps)
+{
+    std::vector<uint16_t> answers(exps.size);
+    std::iota(answers.begin(), answers.end(), 0);
+    return answers;
+}
+
+inline uint8_t n_digits(uint16_t v)
+{
+    return (v >= 1000) ? 4 : ((v >= 100) ? 3 : ((v >= 10) ? 2 : 1));
+}
+
+// write the n digits of v
+inline char *write_number(char *s, uint16_t v, uint8_t n)
+{
+    for (uint8_t i = n; i > 0; --i, v /= 10)
+        s[i - 1] = (char)('0' + v % 10);
+    return s + n;
+}
+
+// every expression, grouped by value and in the order they are enumerated within each value
+static std::vector<char> EXPRESSIONS;                    // L characters per expression
+static std::array<std::vector<uint16_t>, L> EXPRESSION_MASKS;  // premasked symbols by position
+static std::vector<uint16_t> EXPRESSION_INCLUDES;              // premasked expressions
+static std::vector<uint32_t> EXPRESSION_START;  // index of the first expression of each value, then the end
+
+// enumerate every expression once, and group them by their value
+// values are computed as uint16_t, as in the original search, so every value has its own group
+void build_expressions()
+{
+    std::vector<uint16_t> values;
+    std::vector<char> expressions;
+
+    auto add = [&](int value, uint16_t v, uint8_t vn, Symbol op1, uint16_t w, uint8_t wn)
+    {
+        values.push_back((uint16_t)value);
+        expressions.resize(expressions.size() + L);
+        char *s = &expressions[expressions.size() - L];
+        s = write_number(s, v, vn);
+        *s++ = SYMBOLS[op1];
+        write_number(s, w, wn);
+    };
+
+    auto add3 = [&](int value, uint16_t v, uint8_t vn, Symbol op1, uint16_t w, uint8_t wn, Symbol op2,
+                    uint16_t x)
+    {
+        add(value, v, vn, op1, w, wn);
+        char *s = &expressions[expressions.size() - L + vn + 1 + wn];
+        *s++ = SYMBOLS[op2];
+        write_number(s, x, (uint8_t)(L - 2 - vn - wn));
+    };
+
+    static uint16_t maxes[5] = {0, 9, 99, 999, 9999};
+    for (uint16_t v = 1; v <= maxes[4]; ++v)
+    {
+        const uint8_t vn = n_digits(v);
+        const uint16_t w_max = maxes[5 - vn];
+
+        for (uint16_t w = 1; w <= w_max; ++w)
+        {
+            const uint8_t wn = n_digits(w);
+            const uint16_t x_max = maxes[5 - vn - wn];
+
+            for (uint16_t x = 1; x <= x_max; ++x)
+            {
+                const uint8_t xn = n_digits(x);
+
+                if (vn + wn + xn == 4)
+                {
+                    add3(v + w + x, v, vn, PLUS, w, wn, PLUS, x);
+                    add3(v + w - x, v, vn, PLUS, w, wn, MINUS, x);
+                    add3(v + w * x, v, vn, PLUS, w, wn, MULT, x);
+                    add3(v - w * x, v, vn, MINUS, w, wn, MULT, x);
+                    add3(v * w + x, v, vn, MULT, w, wn, PLUS, x);
+                    add3(v * w - x, v, vn, MULT, w, wn, MINUS, x);
+                    add3(v * w * x, v, vn, MULT, w, wn, MULT, x);
+
+                    if (v > w)
+                    {
+                        add3(v - w + x, v, vn, MINUS, w, wn, PLUS, x);
+                        add3(v - w - x, v, vn, MINUS, w, wn, MINUS, x);
+                    }
+
+                    const bool vwd = v % w == 0;
+                    const bool wxd = w % x == 0;
+
+                    if (vwd)
+                    {
+                        add3(v / w + x, v, vn, DIV, w, wn, PLUS, x);
+                        add3(v / w - x, v, vn, DIV, w, wn, MINUS, x);
+                        add3(v / w * x, v, vn, DIV, w, wn, MULT, x);
+                    }
+
+                    if (wxd)
+                    {
+                        add3(v + w / x, v, vn, PLUS, w, wn, DIV, x);
+                        add3(v - w / x, v, vn, MINUS, w, wn, DIV, x);
+                    }
+
+                    if ((v * w) % x == 0)
+                        add3(v * w / x, v, vn, MULT, w, wn, DIV, x);
+                    if (vwd and (v / w) % x == 0)
+                        add3(v / w / x, v, vn, DIV, w, wn, DIV, x);
+                }
+            }
+
+            if (vn + wn == 5)
+            {
+                add(v + w, v, vn, PLUS, w, wn);
+                add(v - w, v, vn, MINUS, w, wn);
+                add(v * w, v, vn, MULT, w, wn);
+                if (v % w == 0)
+                    add(v / w, v, vn, DIV, w, wn);
+            }
+        }
+    }
+
+    // stable counting sort by value
+    EXPRESSION_START.assign((size_t)std::numeric_limits<uint16_t>::max() + 2, 0);
+    for (const auto &value : values)
+        ++EXPRESSION_START[value + 1];
+    std::partial_sum(EXPRESSION_START.begin(), EXPRESSION_START.end(), EXPRESSION_START.begin());
+
+    std::vector<uint32_t> next(EXPRESSION_START.begin(), EXPRESSION_START.end() - 1);
+    EXPRESSIONS.resize(expressions.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        memcpy(&EXPRESSIONS[(size_t)next[values[i]]++ * L], &expressions[i * L], L);
+
+    for (auto &masks : EXPRESSION_MASKS)
+        masks.resize(values.size());
+    EXPRESSION_INCLUDES.assign(values.size(), 0);
+    for (size_t k = 0; k < values.size(); ++k)
+        for (uint8_t i = 0; i < L; ++i)
+            EXPRESSION_INCLUDES[k] |= (EXPRESSION_MASKS[i][k] = get_mask(EXPRESSIONS[k * L + i]));
+}
+
+// select the expressions equal to value, building the store on first use
+Expressions populate_expressions(uint16_t value)
+{
+    if (EXPRESSION_START.empty())
+        build_expressions();
+
+    const uint32_t start = EXPRESSION_START[value];
+    Expressions exps;
+    exps.exps = reinterpret_cast<const char(*)[L]>(&EXPRESSIONS[(size_t)start * L]);
+    for (uint8_t i = 0; i < L; ++i)
+        exps.masks[i] = &EXPRESSION_MASKS[i][start];
+    exps.includes = &EXPRESSION_INCLUDES[start];
+    exps.size = (uint16_t)(EXPRESSION_START[value + 1] - start);
+    return exps;
+}
+
+bool play(Results result[L], const char *guess, const char *hidden)
+{
+    bool r = true;
+    bool done[L];
+
+    for (uint8_t i = 0; i < L; ++i)
+    {
+        r &= (done[i] = guess[i] == hidden[i]);
+        result[i] = (done[i]) ? GREEN : BLACK;
+    }
+
+    if (not r)
+        for (uint8_t i = 0; i < L; ++i)
+            if (result[i] != GREEN)
+                for (uint8_t j = 0; j < L; ++j)
+                    if (guess[i] == hidden[j] and not done[j] and i != j)
+                    {
+                        done[j] = true;
+                        result[i] = YELLOW;
+                        break;
+                    }
+
+    return r;
+}
+
+void print_move(std::ostream &out, Results result[L], const char *guess, const char *hidden = nullptr)
+{
+    for (uint8_t i = 0; i < L; ++i)
+        out << COLOR[result[i]] << guess[i];
+
+    out << RST;
+    if (hidden)
+    {
+        out << " / ";
+        for (uint8_t i = 0; i < L; ++i)
+            out << hidden[i];
+    }
+}
+
+static ThreadPool POOL;  // worker threads for searching
+
+// the expressions of one value and the best plays found for them, so each value can be solved independently
+struct Context
+{
+    explicit Context(uint16_t value)
+      : exps(populate_expressions(value))
+    {
+    }
+
+    Expressions exps;
+    // keyed by the fingerprint of the remaining answers, which is all the best play depends on
+    // only one thread searches a value at a time
+    FlatCache<Fingerprint, uint16_t, FingerprintHash, 1> guess_cache;
+};
+
+const char *find_guess(Context &context, const State &state, const std::vector<uint16_t> &answers)
+{
+    const Expressions &exps = context.exps;
+    if (answers.size() == 1)  // only one word left
+        return exps[answers[0]];
+
+    // lookup result from cache if the best play for these answers was already computed
+    const Fingerprint key = fingerprint(answers.data(), answers.size() * sizeof(uint16_t));
+    uint16_t cached;
+    if (context.guess_cache.find(key, cached))
+        return exps[cached];
+
+    const PackedAnswers packed(exps, answers);
+    std::vector<float> best_score(POOL.size(), -1);
+    std::vector<uint16_t> best_word(POOL.size(), 0);
+
+    POOL.parallel_for(exps.size, 16,
+                      [&](unsigned id, uint32_t start, uint32_t end)
+                      {
+                          for (uint16_t i = (uint16_t)start; i < end; ++i)
+                          {
+                              float score = 0;
+                              const char *guess = exps[i];
+                              for (const auto &answer : answers)
+                              {
+                                  Results result[L];
+                                  play(result, guess, exps[answer]);
+
+                                  State next = state;
+                                  next.apply(result, guess);
+                                  score += (float)(answers.size() - next.num_answers(packed));
+                              }
+
+                              // ties go to the first expression
+                              if (score > best_score[id] or (score == best_score[id] and i < best_word[id]))
+                              {
+                                  best_score[id] = score;
+                                  best_word[id] = i;
+                              }
+                          }
+                      });
+
+    for (unsigned i = 1; i < POOL.size(); ++i)
+        if (best_score[i] > best_score[0] or (best_score[i] == best_score[0] and best_word[i] < best_word[0]))
+        {
+            best_score[0] = best_score[i];
+            best_word[0] = best_word[i];
+        }
+
+    context.guess_cache.insert(key, best_word[0]);
+    return exps[best_word[0]];
+}
+
+// play every expression of one value, returning the average number of guesses
+float evaluate_value(Context &context, std::ostream &out, bool verbose)
+{
+    const Expressions &exps = context.exps;
+    const std::vector<uint16_t> all = all_answers(exps);
+
+    float avg = 0;
+    Results result[L];
+    for (uint16_t i = 0; i < exps.size; ++i)
+    {
+        State state;
+        std::vector<uint16_t> answers = all;
+        const char *hidden = exps[i];
+
+        int j = 0;
+        bool r = true;
+        for (; j < 6 and r; ++j)
+        {
+            const char *guess = find_guess(context, state, answers);
+            r = not play(result, guess, hidden);
+            if (verbose)
+            {
+                print_move(out, result, guess);
+                out << " ";
+            }
+
+            state.apply(result, guess);
+            state.valid_answers(exps, answers);
+        }
+
+        j += r;
+
+        if (verbose and not r)
+            out << j << std::endl;
+        else if (verbose)
+            out.write(hidden, L) << std::endl;
+
+        avg += (float)j;
+    }
+
+    return avg / (float)exps.size;
+}
+
+// values are solved in parallel, each with its own context, and their traces printed in order
+// a single value is instead solved serially, with the search for each guess in parallel
+float evaluate(uint16_t value, bool all = false, bool verbose = true)
+{
+    const uint16_t min_v = (all) ? 0 : value;
+    const uint16_t max_v = (all) ? 100 : (uint16_t)(value + 1);
+    const uint16_t n = (uint16_t)(max_v - min_v);
+
+    std::deque<Context> contexts;
+    for (uint16_t v = min_v; v < max_v; ++v)
+        contexts.emplace_back(v);
+
+    std::vector<float> avgs(n);
+    std::vector<std::ostringstream> traces(n);
+    POOL.parallel_for(n, 1,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          for (uint32_t i = start; i < end; ++i)
+                          {
+                              avgs[i] = evaluate_value(contexts[i], traces[i], verbose);
+                              contexts[i].guess_cache.clear();
+                          }
+                      });
+
+    float global_avg = 0;
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        std::cout << traces[i].str();
+        global_avg += avgs[i];
+    }
+
+    global_avg /= (float)n;
+    return global_avg;
+}
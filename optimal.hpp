@@ -0,0 +1,486 @@
+#pragma once
+
+#include "wordle.hpp"
+
+// exact search for the decision tree with the fewest total guesses over all answers
+//
+// cost(S) = |S| + min over guesses g of the sum of cost(B), for each bucket B that g splits S into other than
+// the answer g itself, found by a memoized depth first branch and bound
+// the average number of guesses of the optimal tree is cost(all answers) / N_VALID
+
+// cost of a set of answers and its best guess
+// `cost` is exact if `exact`, otherwise a lower bound
+struct OptimalEntry
+{
+    uint32_t cost;
+    uint16_t word;
+    bool exact;
+};
+
+// memoized costs, keyed by the fingerprint of the answer set, which can be shared between threads
+class OptimalMemo
+{
+public:
+    bool find(const Fingerprint &key, OptimalEntry &entry) const
+    {
+        return table.find(key, entry);
+    }
+
+    // exact costs replace bounds, and bounds only ever increase
+    void insert(const Fingerprint &key, const OptimalEntry &entry)
+    {
+        table.insert(key, entry,
+                     [](OptimalEntry &current, const OptimalEntry &entry)
+                     {
+                         if (not current.exact and (entry.exact or entry.cost > current.cost))
+                             current = entry;
+                     });
+    }
+
+    FlatCache<Fingerprint, OptimalEntry, FingerprintHash> table;
+};
+
+static OptimalMemo OPTIMAL_MEMO;
+
+// PATTERNS transposed, one row of N_WORDS per answer, so that the results of every guess against a small set
+// of answers can be read sequentially
+template <uint8_t L>
+static std::vector<Code<L>> ANSWER_PATTERNS;
+
+// lower bound on the cost of n answers, indexed by n
+// each guess solves at most one answer, and has at most N_PATTERNS - 1 other outcomes,
+// so guess d solves at most (N_PATTERNS - 1)^(d - 1) answers
+static std::vector<uint32_t> LOWER_BOUND;
+
+template <uint8_t L>
+void init_optimal()
+{
+    ANSWER_PATTERNS<L>.resize((size_t)N_VALID * N_WORDS);
+    for (uint16_t i = 0; i < N_WORDS; ++i)
+        for (uint16_t j = 0; j < N_VALID; ++j)
+            ANSWER_PATTERNS<L>[(size_t)j * N_WORDS + i] = get_pattern<L>(i, j);
+
+    LOWER_BOUND.assign(N_VALID + 1, 0);
+    for (uint32_t n = 1; n <= N_VALID; ++n)
+    {
+        uint32_t remaining = n, depth = 1;
+        uint64_t capacity = 1;
+        while (remaining)
+        {
+            const uint32_t solved = (uint32_t)std::min<uint64_t>(remaining, capacity);
+            LOWER_BOUND[n] += depth * solved;
+            remaining -= solved;
+            capacity = std::min<uint64_t>(capacity * (N_PATTERNS<L> - 1), U32MAX);
+            ++depth;
+        }
+    }
+}
+
+inline Fingerprint answers_key(const std::vector<uint16_t> &answers)
+{
+    return fingerprint(answers.data(), answers.size() * sizeof(uint16_t));
+}
+
+// lower bound on the cost of the answers, exact if `exact` is set, and only tightened as far as `beta`
+// below N_PATTERNS answers, a bucket of c answers costs at least 2c - 1, so the bound of a guess is 2n, less
+// one if it could be the answer, plus one for each answer which shares its result with an earlier one
+// only a guess which could be the answer and tells the others apart reaches 2n - 1, so that is checked first,
+// then with `ahead` every other guess is bounded too, and the least bound is memoized
+template <uint8_t L>
+uint32_t bound_optimal(const std::vector<uint16_t> &answers, bool ahead, uint32_t beta, bool &exact)
+{
+    const uint32_t n = (uint32_t)answers.size();
+    exact = n <= 2;
+    if (n <= 2 or n >= N_PATTERNS<L>)
+        return LOWER_BOUND[n];
+
+    const Fingerprint key = answers_key(answers);
+    OptimalEntry entry = {LOWER_BOUND[n], 0, false};
+    if (OPTIMAL_MEMO.find(key, entry) and (entry.exact or entry.cost >= 2 * n))
+    {
+        exact = entry.exact;
+        return entry.cost;
+    }
+
+    std::vector<const Code<L> *> columns(n);
+    for (uint32_t k = 0; k < n; ++k)
+        columns[k] = &ANSWER_PATTERNS<L>[(size_t)answers[k] * N_WORDS];
+
+    // bound guess i, stopping once it cannot be below the least bound so far
+    // the bound is exact if every bucket has at most 2 answers
+    std::vector<uint8_t> counts(N_PATTERNS<L>, 0);
+    uint32_t least = beta;
+    uint16_t word = 0;
+    auto bound = [&](uint16_t i, uint32_t answer)
+    {
+        const uint32_t base = 2 * n - answer;
+        const uint32_t most = (least > base) ? least - base : 0;
+        uint32_t shared = 0, k = 0;
+        bool small = true;
+        for (; k < n and shared < most; ++k)
+        {
+            uint8_t &count = counts[columns[k][i]];
+            shared += count != 0;
+            small &= count < 2;
+            count = (uint8_t)std::min(count + 1, 2);
+        }
+
+        for (uint32_t j = 0; j < k; ++j)
+            counts[columns[j][i]] = 0;
+
+        // a guess which leaves every answer in one bucket makes no progress
+        if (shared < most and shared < n - 1)
+        {
+            least = base + shared;
+            exact = small;
+            word = i;
+        }
+    };
+
+    std::vector<bool> seen(N_WORDS, false);
+    for (const auto &answer : answers)
+    {
+        seen[ANSWER_GUESS[answer]] = true;
+        bound(ANSWER_GUESS[answer], 1);
+        if (least == 2 * n - 1)
+            break;
+    }
+
+    // any other guess leaves every answer unsolved, so costs at least 2n
+    if (least > 2 * n)
+    {
+        if (not ahead)
+        {
+            exact = false;
+            return std::max(entry.cost, 2 * n);
+        }
+
+        for (uint16_t i = 0; i < N_WORDS; ++i)
+            if (not seen[i])
+                bound(i, 0);
+    }
+
+    OPTIMAL_MEMO.insert(key, {least, word, exact});
+    return std::max(entry.cost, least);
+}
+
+template <uint8_t L>
+uint32_t solve_optimal(const std::vector<uint16_t> &answers, uint32_t beta, uint16_t *word = nullptr);
+
+// cost of playing `word` against the answers, exact if below `beta`, otherwise a lower bound of at least
+// `beta`
+template <uint8_t L>
+uint32_t play_optimal(const std::vector<uint16_t> &answers, uint16_t word, uint32_t beta)
+{
+    const Code<L> *row = &PATTERNS<L>[(size_t)word * N_VALID];
+
+    // split the answers into buckets by result, largest first so hopeless guesses are cut early
+    std::vector<uint16_t> sizes(N_PATTERNS<L>, 0);
+    for (const auto &answer : answers)
+        ++sizes[row[answer]];
+
+    std::vector<uint32_t> start(N_PATTERNS<L> + 1, 0);
+    std::vector<uint16_t> codes;
+    uint32_t bound = (uint32_t)answers.size();
+    for (uint16_t j = 0; j < N_PATTERNS<L>; ++j)
+    {
+        start[j + 1] = start[j] + sizes[j];
+        if (sizes[j] and j != WIN<L>)
+        {
+            codes.push_back(j);
+            bound += LOWER_BOUND[sizes[j]];
+        }
+    }
+
+    std::vector<uint16_t> sorted(answers.size());
+    std::vector<uint32_t> next(start.begin(), start.end() - 1);
+    for (const auto &answer : answers)
+        sorted[next[row[answer]]++] = answer;
+
+    std::stable_sort(codes.begin(), codes.end(), [&](uint16_t a, uint16_t b) { return sizes[a] > sizes[b]; });
+
+    // tighten the bound of each bucket, then replace the bounds with costs, stopping once the total cannot be
+    // below beta
+    // sets too large for one guess to tell apart are few, but most of their guesses are only cut by looking
+    // one guess further ahead in every bucket
+    const bool ahead = answers.size() >= N_PATTERNS<L>;
+    std::vector<std::vector<uint16_t>> buckets;
+    std::vector<uint32_t> lowers;
+    uint32_t cost = bound;
+    for (const auto &code : codes)
+    {
+        if (cost >= beta)
+            return cost;
+
+        bool exact;
+        const uint32_t size_lower = LOWER_BOUND[sizes[code]];
+        std::vector<uint16_t> bucket(sorted.begin() + start[code], sorted.begin() + start[code + 1]);
+        const uint32_t lower = bound_optimal<L>(bucket, ahead, beta - (cost - size_lower), exact);
+        cost += lower - size_lower;
+        if (not exact)
+        {
+            buckets.push_back(std::move(bucket));
+            lowers.push_back(lower);
+        }
+    }
+
+    for (size_t b = 0; b < buckets.size() and cost < beta; ++b)
+        cost += solve_optimal<L>(buckets[b], beta - (cost - lowers[b])) - lowers[b];
+
+    return cost;
+}
+
+// optimal cost of the answers, exact if below `beta`, otherwise a lower bound of at least `beta`
+// if exact and `word` is given, sets it to the best guess
+// ties between guesses go to one which could be the answer, then the smallest (bound, sum of squared bucket
+// sizes, index)
+template <uint8_t L>
+uint32_t solve_optimal(const std::vector<uint16_t> &answers, uint32_t beta, uint16_t *word)
+{
+    const uint32_t n = (uint32_t)answers.size();
+    if (n <= 2)
+    {
+        if (word)
+            *word = ANSWER_GUESS[answers[0]];
+        return LOWER_BOUND[n];
+    }
+
+    const Fingerprint key = answers_key(answers);
+    OptimalEntry entry;
+    uint32_t lower = LOWER_BOUND[n];
+    if (OPTIMAL_MEMO.find(key, entry))
+    {
+        if (entry.exact and word)
+            *word = entry.word;
+        if (entry.exact or entry.cost >= beta)
+            return entry.cost;
+        lower = std::max(lower, entry.cost);
+    }
+
+    if (lower >= beta)
+        return lower;
+
+    // bound every guess that makes progress by the lower bounds of its buckets
+    struct Candidate
+    {
+        uint32_t bound;
+        uint64_t squares;
+        uint16_t word;
+
+        bool operator<(const Candidate &other) const
+        {
+            return std::tie(bound, squares, word) < std::tie(other.bound, other.squares, other.word);
+        }
+    };
+
+    std::vector<Candidate> candidates;
+    uint32_t floor = U32MAX;  // least bound of the guesses not searched
+    uint32_t best = beta, best_rank = 0;
+    std::vector<uint16_t> counts(N_PATTERNS<L>, 0);
+
+    // results of every guess against each answer, from the answer-major table so that the guesses are read in
+    // order from one row per answer
+    std::vector<const Code<L> *> columns(n);
+    for (uint32_t k = 0; k < n; ++k)
+        columns[k] = &ANSWER_PATTERNS<L>[(size_t)answers[k] * N_WORDS];
+
+    // bound guess i, given whether it is one of the answers
+    // returns true if the guess is known to be optimal
+    auto bound = [&](uint16_t i, uint32_t answer)
+    {
+        // below N_PATTERNS answers the bound grows by one for each answer which shares its result with an
+        // earlier one, as in bound_optimal, so the guess is cut as soon as it reaches the best cost
+        const uint32_t base = 2 * n - answer;
+        const uint32_t most = (n >= N_PATTERNS<L>) ? U32MAX : (best > base) ? best - base : 0;
+        uint32_t shared = 0, k = 0;
+        for (; k < n and shared < most; ++k)
+            shared += counts[columns[k][i]]++ != 0;
+
+        if (shared >= most)
+        {
+            for (uint32_t j = 0; j < k; ++j)
+                counts[columns[j][i]] = 0;
+            floor = std::min(floor, best);
+            return false;
+        }
+
+        Candidate candidate = {n, 0, i};
+        bool splits = true, exact = true;
+        for (uint32_t k = 0; k < n; ++k)
+        {
+            const Code<L> code = columns[k][i];
+            const uint16_t count = counts[code];
+            if (not count)
+                continue;
+
+            counts[code] = 0;
+            candidate.squares += (uint64_t)count * count;
+            if (code != WIN<L>)
+            {
+                candidate.bound += LOWER_BOUND[count];
+                exact &= count <= 2;
+                splits &= count < n;
+            }
+        }
+
+        if (not splits)
+            return false;
+
+        // every bucket is solved as well as any set of its size could be, so nothing can do better
+        if (exact and candidate.bound == lower)
+        {
+            OPTIMAL_MEMO.insert(key, {lower, i, true});
+            if (word)
+                *word = i;
+            return true;
+        }
+
+        if (candidate.bound >= best)
+            floor = std::min(floor, candidate.bound);
+        else
+            candidates.push_back(candidate);
+        return false;
+    };
+
+    // search candidates[first:] in order, in parallel with any idle workers, at whatever depth they find it
+    // the best guess is the first in order with the least cost, whichever thread finds it
+    std::mutex mutex;
+    auto search = [&](size_t first)
+    {
+        std::sort(candidates.begin() + (ptrdiff_t)first, candidates.end());
+        POOL.parallel_for((uint32_t)(candidates.size() - first), 1,
+                          [&](unsigned, uint32_t start, uint32_t end)
+                          {
+                              for (uint32_t r = (uint32_t)first + start; r < first + end; ++r)
+                              {
+                                  uint32_t limit;
+                                  {
+                                      std::lock_guard<std::mutex> lock(mutex);
+                                      limit = best + (r < best_rank);
+                                  }
+
+                                  const Candidate &candidate = candidates[r];
+                                  const uint32_t cost = (candidate.bound >= limit)
+                                                            ? candidate.bound
+                                                            : play_optimal<L>(answers, candidate.word, limit);
+
+                                  std::lock_guard<std::mutex> lock(mutex);
+                                  if (cost < best or (cost == best and r < best_rank))
+                                      best = cost, best_rank = r;
+                                  else
+                                      floor = std::min(floor, cost);
+
+                                  // candidates are sorted by bound, so no later candidate can do better
+                                  if (candidate.bound >= best)
+                                  {
+                                      floor = std::min(floor, candidate.bound);
+                                      break;
+                                  }
+                              }
+                          });
+    };
+
+    // guesses which could be the answer first
+    std::vector<bool> seen(N_WORDS, false);
+    for (const auto &answer : answers)
+    {
+        const uint16_t i = ANSWER_GUESS[answer];
+        seen[i] = true;
+        if (bound(i, 1))
+            return lower;
+    }
+
+    // any other guess leaves every answer unsolved, so costs at least 2n
+    uint32_t least = std::min(floor, 2 * n);
+    for (const auto &candidate : candidates)
+        least = std::min(least, candidate.bound);
+    lower = std::max(lower, least);
+
+    search(0);
+
+    // then the other guesses, only if they could do strictly better
+    if (2 * n < best)
+    {
+        const size_t first = candidates.size();
+        for (uint16_t i = 0; i < N_WORDS; ++i)
+            if (not seen[i] and bound(i, 0))
+                return lower;
+        search(first);
+    }
+    else
+        floor = std::min(floor, 2 * n);
+
+    if (best < beta)
+    {
+        OPTIMAL_MEMO.insert(key, {best, candidates[best_rank].word, true});
+        if (word)
+            *word = candidates[best_rank].word;
+        return best;
+    }
+
+    floor = std::max(floor, beta);
+    OPTIMAL_MEMO.insert(key, {floor, 0, false});
+    return floor;
+}
+
+// best guess for the answers in the optimal tree
+template <uint8_t L>
+uint16_t optimal_guess(const std::vector<uint16_t> &answers)
+{
+    // the search returns the guess itself, as a bounded memo may already have evicted its entry
+    uint16_t word;
+    solve_optimal<L>(answers, U32MAX, &word);
+    return word;
+}
+
+// find the optimal tree, then print the game it plays against every answer as in evaluate()
+// returns the average number of guesses
+template <uint8_t L>
+float evaluate_optimal(bool verbose = true)
+{
+    init_optimal<L>();
+
+    std::vector<uint16_t> all(N_VALID);
+    std::iota(all.begin(), all.end(), 0);
+    const uint32_t total = solve_optimal<L>(all, U32MAX);
+
+    std::vector<uint32_t> totals;
+    Results result[L];
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        std::vector<uint16_t> answers = all;
+        std::ostringstream out;
+
+        uint32_t j = 0;
+        for (bool r = true; r; ++j)
+        {
+            const uint16_t index = optimal_guess<L>(answers);
+            const uint32_t code = get_pattern<L>(index, i);
+
+            r = code != WIN<L>;
+            decode<L>(result, code);
+            print_move<L>(out, result, get_word(index));
+            out << " ";
+
+            const auto other = [&](uint16_t answer) { return get_pattern<L>(index, answer) != code; };
+            answers.erase(std::remove_if(answers.begin(), answers.end(), other), answers.end());
+        }
+
+        out << j;
+        if (verbose)
+            std::cout << out.str() << std::endl;
+
+        totals.resize(std::max<size_t>(totals.size(), j), 0);
+        ++totals[j - 1];
+    }
+
+    const float avg = (float)total / (float)N_VALID;
+    if (verbose)
+    {
+        for (const auto &count : totals)
+            std::cout << count << " ";
+        std::cout << "Avg: " << avg << std::endl;
+    }
+
+    return avg;
+}
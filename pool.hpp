@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "stats.hpp"
+
+// long-lived pool of worker threads for data parallel loops
+// the calling thread takes part in every loop, as worker 0 unless it is one of the workers
+// loops started from inside a loop or from several threads at once are shared with whichever workers are
+// idle, so the work of a long chunk can be split further
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned n = std::thread::hardware_concurrency())
+    {
+        n = std::max(n, 1u);
+        std::vector<ThreadStats>(n).swap(thread_stats);
+        for (unsigned id = 1; id < n; ++id)
+            workers.emplace_back([this, id]() { work(id); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+
+        wake.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // number of threads taking part in a loop, including the caller
+    unsigned size() const
+    {
+        return (unsigned)workers.size() + 1;
+    }
+
+    // run fn(id, begin, end) over chunks of [0, n), with id in [0, size()) and different for each thread
+    // taking part in the loop
+    // chunks are handed out on demand, so threads that finish early take more of the range
+    // loops started while no worker is idle run inline
+    template <typename F>
+    void parallel_for(uint32_t n, uint32_t chunk, F &&fn)
+    {
+        // a nested loop is timed by the loop around it, any other is charged to the caller
+        const bool nested = in_loop;
+        const uint64_t start = stats_clock();
+        in_loop = true;
+
+        if (workers.empty() or n <= chunk or not idle.load(std::memory_order_relaxed))
+        {
+            fn(self, 0u, n);
+            in_loop = nested;
+            if (STATS_ENABLED and not nested)
+                record(start);
+            return;
+        }
+
+        std::atomic<uint32_t> next{0};
+        Loop loop;
+        loop.run = [&, n, chunk](unsigned id)
+        {
+            const uint64_t start = stats_clock();
+
+            uint32_t begin, chunks = 0;
+            while ((begin = next.fetch_add(chunk, std::memory_order_relaxed)) < n)
+            {
+                fn(id, begin, std::min(begin + chunk, n));
+                ++chunks;
+            }
+
+            thread_stats[id].busy_ns.add(stats_clock() - start);
+            thread_stats[id].chunks.add(chunks);
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            open.push_back(&loop);
+        }
+        wake.notify_all();
+
+        loop.run(self);
+        in_loop = nested;
+
+        {
+            // every chunk is taken, so wait for the workers still running one
+            std::unique_lock<std::mutex> lock(mutex);
+            open.erase(std::find(open.begin(), open.end(), &loop));
+            done.wait(lock, [&]() { return loop.helpers == 0; });
+        }
+
+        if (not nested)
+        {
+            loops.add();
+            loop_ns.add(stats_clock() - start);
+        }
+    }
+
+    // time each thread spent working in parallel loops, only collected with SOLVER_STATS
+    // loops run inline can be charged to worker 0 from several threads at once, so these are counters
+    struct alignas(64) ThreadStats
+    {
+        Counter busy_ns;
+        Counter chunks;
+    };
+
+    const std::vector<ThreadStats> &stats() const
+    {
+        return thread_stats;
+    }
+
+    Counter loops;    // number of parallel loops run, including those run inline by a single thread
+    Counter loop_ns;  // total wall time of parallel loops
+
+private:
+    // a loop shared with the workers
+    struct Loop
+    {
+        std::function<void(unsigned)> run;  // takes chunks until none are left
+        unsigned helpers = 0;               // workers running it
+        bool taken = false;                 // set once a worker has found no chunks left
+    };
+
+    // charge a loop run inline since `start` to the caller
+    void record(uint64_t start)
+    {
+        const uint64_t ns = stats_clock() - start;
+        thread_stats[self].busy_ns.add(ns);
+        thread_stats[self].chunks.add();
+        loops.add();
+        loop_ns.add(ns);
+    }
+
+    // oldest shared loop which may have chunks left, whose chunks are the largest pieces of work
+    Loop *next_loop() const
+    {
+        for (Loop *loop : open)
+            if (not loop->taken)
+                return loop;
+        return nullptr;
+    }
+
+    void work(unsigned id)
+    {
+        self = id;
+        in_loop = true;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            Loop *loop = nullptr;
+            idle.fetch_add(1, std::memory_order_relaxed);
+            wake.wait(lock, [&]() { return stop or (loop = next_loop()); });
+            idle.fetch_sub(1, std::memory_order_relaxed);
+            if (stop)
+                return;
+
+            ++loop->helpers;
+            lock.unlock();
+            loop->run(id);
+            lock.lock();
+
+            loop->taken = true;
+            if (--loop->helpers == 0)
+                done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<ThreadStats> thread_stats;
+    std::atomic<unsigned> idle{0};  // workers waiting for a loop
+
+    std::mutex mutex;  // guards the fields below
+    std::condition_variable wake, done;
+    std::vector<Loop *> open;  // shared loops in the order they were started
+    bool stop = false;
+
+    static inline thread_local bool in_loop = false;
+    static inline thread_local unsigned self = 0;  // id of this thread in the loops it starts
+};
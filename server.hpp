@@ -0,0 +1,489 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+
+#include "speculate.hpp"
+#include "wordle.hpp"
+
+// long-running solver which answers queries from many sessions with one warm cache
+//
+// each query is one line of guess/result pairs, e.g. `roate ygbby sling bbgbb`, and is answered with one line
+// holding the next guess, followed by `proven` or `partial` if searches have a deadline, or `error <reason>`
+// an empty line asks for the first guess, and `stats` replies with the latency percentiles as JSON
+// replies on each connection are written in the order the queries arrived
+
+// maximum number of queries answered together
+#define MAX_BATCH 256u
+
+// where queries arrive from and replies are written to
+struct Connection
+{
+    int in, out;
+    bool socket;  // close the descriptor once the last reply is written
+
+    Connection(int in, int out, bool socket)
+      : in(in)
+      , out(out)
+      , socket(socket)
+    {
+    }
+
+    ~Connection()
+    {
+        if (socket)
+            close(in);
+    }
+};
+
+struct Query
+{
+    std::shared_ptr<Connection> connection;
+    std::string line;
+    std::chrono::steady_clock::time_point received;
+    std::string reply;
+};
+
+// queries waiting to be answered, filled by one reader per connection
+class QueryQueue
+{
+public:
+    void push(Query &&query)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queries.push_back(std::move(query));
+        }
+        ready.notify_one();
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_one();
+    }
+
+    // wait for queries and take up to `max` of them, returns false once closed and drained
+    bool pop(std::vector<Query> &batch, size_t max)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return closed or not queries.empty(); });
+
+        batch.clear();
+        while (batch.size() < max and not queries.empty())
+        {
+            batch.push_back(std::move(queries.front()));
+            queries.pop_front();
+        }
+        return not batch.empty();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Query> queries;
+    bool closed = false;
+};
+
+// call fn(line) on each line read from fd until it is closed
+template <typename F>
+void read_lines(int fd, F &&fn)
+{
+    std::string buffer;
+    char data[4096];
+    ssize_t n;
+    while ((n = read(fd, data, sizeof(data))) > 0)
+    {
+        buffer.append(data, (size_t)n);
+
+        size_t start = 0, end;
+        while ((end = buffer.find('\n', start)) != std::string::npos)
+        {
+            fn(std::string(buffer, start, end - start));
+            start = end + 1;
+        }
+        buffer.erase(0, start);
+    }
+
+    if (not buffer.empty())
+        fn(std::move(buffer));
+}
+
+// write all of a reply, giving up if the other end has gone
+void write_all(const Connection &connection, const std::string &data)
+{
+    for (size_t done = 0; done < data.size();)
+    {
+        const size_t size = data.size() - done;
+        const ssize_t n = (connection.socket) ? send(connection.out, &data[done], size, MSG_NOSIGNAL)
+                                              : write(connection.out, &data[done], size);
+        if (n <= 0)
+            return;
+        done += (size_t)n;
+    }
+}
+
+// query latencies, from arrival to reply
+// kept in a fixed histogram of log spaced buckets, so memory and percentile queries do not grow with uptime
+// each power of two nanoseconds is split into 2^LATENCY_SUB_BITS buckets, so percentiles are within 1/16
+#define LATENCY_SUB_BITS 3u
+class Latency
+{
+public:
+    void add(std::chrono::steady_clock::duration d)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        ++counts[bucket((uint64_t)std::max<int64_t>(ns, 0))];
+        ++total;
+    }
+
+    std::string json() const
+    {
+        std::ostringstream out;
+        out << "{\"queries\": " << total << ", \"p50_us\": " << percentile(0.5) / 1e3
+            << ", \"p99_us\": " << percentile(0.99) / 1e3 << "}";
+        return out.str();
+    }
+
+private:
+    static constexpr uint32_t SUB = 1u << LATENCY_SUB_BITS;
+    static constexpr uint32_t BUCKETS = (64 - LATENCY_SUB_BITS + 1) * SUB;
+
+    // small values have a bucket each, larger ones one per SUB steps of each power of two
+    static uint32_t bucket(uint64_t ns)
+    {
+        if (ns < SUB)
+            return (uint32_t)ns;
+        const uint32_t e = 63u - (uint32_t)__builtin_clzll(ns);
+        const uint32_t sub = (uint32_t)(ns >> (e - LATENCY_SUB_BITS)) & (SUB - 1);
+        return (e - LATENCY_SUB_BITS + 1) * SUB + sub;
+    }
+
+    // middle of a bucket
+    static double value(uint32_t i)
+    {
+        if (i < SUB)
+            return i;
+        const uint32_t e = i / SUB + LATENCY_SUB_BITS - 1;
+        const double width = std::ldexp(1.0, (int)(e - LATENCY_SUB_BITS));
+        return (SUB + i % SUB) * width + width / 2;
+    }
+
+    double percentile(double p) const
+    {
+        if (not total)
+            return 0;
+
+        const uint64_t rank = (uint64_t)((double)(total - 1) * p);
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; ++i)
+            if ((seen += counts[i]) > rank)
+                return value(i);
+        return 0;
+    }
+
+    std::array<uint64_t, BUCKETS> counts = {};
+    uint64_t total = 0;
+};
+
+template <uint8_t L>
+class Server
+{
+public:
+    // with `speculate`, the guesses which could follow each reply are searched while waiting for queries
+    explicit Server(bool speculate = false)
+    {
+        for (uint16_t i = 0; i < N_WORDS; ++i)
+            guess_index.emplace(std::string_view(get_word(i), L), i);
+        if (speculate)
+            speculator = std::make_unique<Speculator<L>>();
+    }
+
+    // answer queries from stdin on stdout until stdin is closed
+    void serve_stdin()
+    {
+        auto connection = std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false);
+        std::thread reader(
+            [&]()
+            {
+                read_lines(STDIN_FILENO, [&](std::string &&line) { receive(connection, std::move(line)); });
+                queue.close();
+            });
+
+        answer_all();
+        reader.join();
+    }
+
+    // answer queries from clients of a unix socket until interrupted
+    // returns false if the socket cannot be created
+    bool serve_socket(const char *path)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(address.sun_path))
+        {
+            std::cerr << "Socket path too long: " << path << std::endl;
+            return false;
+        }
+        strcpy(address.sun_path, path);
+
+        const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path);
+        if (listener < 0 or bind(listener, (const sockaddr *)&address, sizeof(address)) or
+            listen(listener, 64))
+        {
+            std::cerr << "Cannot listen on " << path << ": " << strerror(errno) << std::endl;
+            if (listener >= 0)
+                close(listener);
+            return false;
+        }
+
+        // stop on SIGINT or SIGTERM, through a pipe so the accept loop can wait on both
+        if (pipe(stop_pipe))
+            return false;
+        struct sigaction action = {};
+        action.sa_handler = [](int) { (void)!write(stop_pipe[1], "", 1); };
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+
+        std::thread acceptor(
+            [&]()
+            {
+                std::vector<std::weak_ptr<Connection>> connections;
+
+                pollfd fds[2] = {{listener, POLLIN, 0}, {stop_pipe[0], POLLIN, 0}};
+                while (poll(fds, 2, -1) >= 0 or errno == EINTR)
+                {
+                    if (fds[1].revents)
+                        break;
+                    if (not(fds[0].revents & POLLIN))
+                        continue;
+
+                    const int fd = accept(listener, nullptr, nullptr);
+                    if (fd < 0)
+                        continue;
+
+                    // a connection is closed once its reader and all of its queries are done
+                    auto connection = std::make_shared<Connection>(fd, fd, true);
+                    connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                                     [](const auto &c) { return c.expired(); }),
+                                      connections.end());
+                    connections.push_back(connection);
+
+                    std::lock_guard<std::mutex> lock(reader_mutex);
+                    ++readers;
+                    std::thread(
+                        [this, connection]()
+                        {
+                            read_lines(connection->in,
+                                       [&](std::string &&line) { receive(connection, std::move(line)); });
+
+                            std::lock_guard<std::mutex> lock(reader_mutex);
+                            if (--readers == 0)
+                                readers_done.notify_one();
+                        })
+                        .detach();
+                }
+
+                // wake the readers of connections that are still open
+                for (const auto &c : connections)
+                    if (auto connection = c.lock())
+                        shutdown(connection->in, SHUT_RD);
+
+                std::unique_lock<std::mutex> lock(reader_mutex);
+                readers_done.wait(lock, [this]() { return readers == 0; });
+                queue.close();
+            });
+
+        answer_all();
+        acceptor.join();
+
+        close(listener);
+        unlink(path);
+        return true;
+    }
+
+    Latency latency;
+
+private:
+    void receive(const std::shared_ptr<Connection> &connection, std::string &&line)
+    {
+        if (not line.empty() and line.back() == '\r')
+            line.pop_back();
+        queue.push({connection, std::move(line), std::chrono::steady_clock::now(), {}});
+    }
+
+    // answer batches of queries in parallel, sharing the guess cache
+    // replies are written as soon as they are ready, so queries answered from the cache do not wait for
+    // searches, except those of earlier queries on the same connection
+    void answer_all()
+    {
+        std::vector<Query> batch;
+        while (queue.pop(batch, MAX_BATCH))
+        {
+            // queries take priority over speculation, which resumes from the replies once they are sent
+            if (speculator)
+                speculator->pause();
+
+            // replay every query, then write the replies known without searching
+            const uint32_t n = (uint32_t)batch.size();
+            std::vector<Position<L>> positions(n);
+            std::vector<uint8_t> ready(n, false), written(n, false);
+            POOL.parallel_for(n, 1,
+                              [&](unsigned, uint32_t start, uint32_t end)
+                              {
+                                  for (uint32_t i = start; i < end; ++i)
+                                  {
+                                      Query &query = batch[i];
+                                      if (query.line != "stats")
+                                          query.reply = replay(query.line, positions[i]);
+                                      ready[i] = query.line == "stats" or not query.reply.empty();
+                                      if (not query.reply.empty())
+                                          query.reply += "\n";
+                                  }
+                              });
+            flush(batch, ready, written);
+
+            // then search the rest, writing each reply once it and those before it on its connection are done
+            std::mutex mutex;
+            POOL.parallel_for(n, 1,
+                              [&](unsigned, uint32_t start, uint32_t end)
+                              {
+                                  for (uint32_t i = start; i < end; ++i)
+                                  {
+                                      if (ready[i])
+                                          continue;
+
+                                      batch[i].reply = search(positions[i]) + "\n";
+                                      std::lock_guard<std::mutex> lock(mutex);
+                                      ready[i] = true;
+                                      flush(batch, ready, written);
+                                  }
+                              });
+
+            // drop the connections now, so a client which has gone sees the end of its replies
+            batch.clear();
+
+            if (speculator)
+                for (const auto &position : positions)
+                    speculator->speculate(position);
+        }
+    }
+
+    // replay the guesses of a query, setting `position` to the state they reach
+    // returns the reply if it is known without a search, otherwise an empty string
+    std::string replay(const std::string &line, Position<L> &position) const
+    {
+        State<L> state;
+        AnswerSet answers = AnswerSet::all();
+        Results result[L];
+
+        std::istringstream in(line);
+        std::string guess, feedback;
+        bool solved = false;
+        while (in >> guess)
+        {
+            if (solved)
+                return "error guess after solved";
+            if (not(in >> feedback))
+                return "error missing result for " + guess;
+
+            const auto &it = guess_index.find(guess);
+            if (it == guess_index.end())
+                return "error unknown guess " + guess;
+
+            if (feedback.size() != L)
+                return "error bad result " + feedback;
+            for (uint8_t i = 0; i < L; ++i)
+                if (feedback[i] == 'b')
+                    result[i] = BLACK;
+                else if (feedback[i] == 'y')
+                    result[i] = YELLOW;
+                else if (feedback[i] == 'g')
+                    result[i] = GREEN;
+                else
+                    return "error bad result " + feedback;
+
+            const uint32_t code = encode<L>(result);
+            state.apply(result, get_word(it->second));
+            filter_answers(answers, state, it->second, code);
+            solved = code == WIN<L>;
+        }
+
+        // a finished game gets no more guesses
+        if (solved)
+            return "solved";
+
+        if (not answers.count())
+            return "error no answers match";
+
+        position = {state, answers, 0};
+        if (not known_guess(state, answers, position.guess))
+            return {};
+        return reply(position.guess, true);
+    }
+
+    // search the guess to play from a replayed position
+    std::string search(Position<L> &position) const
+    {
+        bool proven;
+        position.guess = find_guess(position.state, position.answers, &proven);
+        return reply(position.guess, proven);
+    }
+
+    // with a deadline, say whether the guess is proven best or only the best found in time
+    static std::string reply(uint16_t guess, bool proven)
+    {
+        const std::string next(get_word(guess), L);
+        if (not DEADLINE_MS)
+            return next;
+        return next + ((proven) ? " proven" : " partial");
+    }
+
+    // write the replies which are ready, in order on each connection, so a reply waits only for earlier
+    // queries on its own connection
+    void flush(std::vector<Query> &batch, const std::vector<uint8_t> &ready, std::vector<uint8_t> &written)
+    {
+        std::vector<const Connection *> waiting;
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            Query &query = batch[i];
+            const Connection *connection = query.connection.get();
+            if (written[i] or std::find(waiting.begin(), waiting.end(), connection) != waiting.end())
+                continue;
+            if (not ready[i])
+            {
+                waiting.push_back(connection);
+                continue;
+            }
+
+            if (query.line == "stats")
+                query.reply = latency.json() + "\n";
+            write_all(*connection, query.reply);
+            latency.add(std::chrono::steady_clock::now() - query.received);
+            written[i] = true;
+        }
+    }
+
+
+    std::unordered_map<std::string, uint16_t> guess_index;
+    QueryQueue queue;
+    std::unique_ptr<Speculator<L>> speculator;
+
+    // readers of open socket connections
+    std::mutex reader_mutex;
+    std::condition_variable readers_done;
+    unsigned readers = 0;
+
+    static inline int stop_pipe[2];
+};
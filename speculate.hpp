@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#include "wordle.hpp"
+
+// speculative search of the guesses which follow a guess, while waiting for its result
+//
+// once a guess is chosen, the answers each of its results would leave are known, so the next guess for each
+// of them can be found before the result arrives, and is then read straight from the guess cache
+// the largest buckets are searched first, as they take longest and are the most likely results
+// one background thread runs the searches, which use the whole thread pool while the caller is idle
+
+// most guesses waiting to be speculated on, the oldest are dropped first
+#define MAX_SPECULATIONS 64u
+
+// a guess about to be played, from the state and answers before it
+template <uint8_t L>
+struct Position
+{
+    State<L> state;
+    AnswerSet answers;
+    uint16_t guess = 0;
+};
+
+template <uint8_t L>
+class Speculator
+{
+public:
+    Speculator()
+      : worker([this]() { run(); })
+    {
+    }
+
+    ~Speculator()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = cancel = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    // search the answers left by each result of the position's guess in the background
+    void speculate(const Position<L> &position)
+    {
+        if (position.answers.count() <= 1)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.size() == MAX_SPECULATIONS)
+                jobs.pop_front();
+            jobs.push_back(position);
+            cancel = false;
+        }
+        wake.notify_one();
+    }
+
+    // drop the waiting positions and cancel the search in progress, so the caller has the thread pool to
+    // itself within 64 candidates of that search
+    void pause()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobs.clear();
+        cancel = true;
+        idle.wait(lock, [this]() { return not busy; });
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [this]() { return stop or not jobs.empty(); });
+            if (stop)
+                return;
+
+            const Position<L> position = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+
+            lock.unlock();
+            search(position);
+            lock.lock();
+
+            busy = false;
+            idle.notify_all();
+        }
+    }
+
+    // find the next guess for every result with more than one answer left, largest bucket first
+    // searches ignore any deadline, so that every guess they cache is the best, but stop once cancelled
+    void search(const Position<L> &position)
+    {
+        std::vector<uint16_t> sizes(N_PATTERNS<L>, 0);
+        position.answers.for_each([&](uint16_t answer) { ++sizes[get_pattern<L>(position.guess, answer)]; });
+
+        std::vector<uint32_t> codes;
+        for (uint32_t code = 0; code < N_PATTERNS<L>; ++code)
+            if (sizes[code] > 1 and code != WIN<L>)
+                codes.push_back(code);
+        const auto larger = [&](uint32_t a, uint32_t b) { return sizes[a] > sizes[b]; };
+        std::stable_sort(codes.begin(), codes.end(), larger);
+
+        Results result[L];
+        for (const auto &code : codes)
+        {
+            if (cancel)
+                return;
+
+            State<L> state = position.state;
+            AnswerSet answers = position.answers;
+            decode<L>(result, code);
+            state.apply(result, get_word(position.guess));
+            filter_answers(answers, state, position.guess, code);
+
+            find_guess(state, answers, nullptr, 0, &cancel);
+            if (not cancel)
+                STATS.speculated.add();
+        }
+    }
+
+    std::mutex mutex;  // guards the fields below
+    std::condition_variable wake, idle;
+    std::deque<Position<L>> jobs;
+    bool busy = false;
+    bool stop = false;
+    std::atomic<bool> cancel{false};  // abandon the position being searched
+
+    std::thread worker;
+};
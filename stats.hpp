@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+// statistics are only collected when built with SOLVER_STATS (cmake -DSOLVER_STATS=ON)
+// otherwise every update below compiles to nothing
+#if defined(SOLVER_STATS)
+#define STATS_ENABLED true
+#else
+#define STATS_ENABLED false
+#endif
+
+// event counter which can be updated from any thread
+class Counter
+{
+public:
+    inline void add(uint64_t n = 1)
+    {
+        if constexpr (STATS_ENABLED)
+            value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// nanoseconds on a monotonic clock, or 0 when statistics are disabled
+inline uint64_t stats_clock()
+{
+    if constexpr (STATS_ENABLED)
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    return 0;
+}
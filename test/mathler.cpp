@@ -0,0 +1,76 @@
+#include <random>
+
+#include "mathler.hpp"
+
+// checks the vectorized count kernel against the scalar one, and both against State::is_valid, over random
+// states and random subsets of the answers, whose sizes leave padded lanes in the last pass
+
+#define VALUES 101  // values checked, as evaluated by ./mathler
+#define STATES 200  // random states per value
+
+// a state from the results of a few random plays, or from random masks, which reach states no play does
+State random_state(const Expressions &exps, std::mt19937 &rng)
+{
+    State state;
+    if (rng() % 2)
+    {
+        Results result[L];
+        for (uint32_t plays = 1 + (uint32_t)(rng() % 3); plays; --plays)
+        {
+            const char *guess = exps[(uint16_t)(rng() % exps.size)];
+            play(result, guess, exps[(uint16_t)(rng() % exps.size)]);
+            state.apply(result, guess);
+        }
+    }
+    else
+    {
+        for (uint8_t i = 0; i < L; ++i)
+            state.valid[i] = (rng() | rng()) & 0x3fff;
+        state.include = rng() & rng() & rng() & 0x3fff;
+    }
+    return state;
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    uint32_t checked = 0;
+    for (uint16_t value = 0; value < VALUES; ++value)
+    {
+        const Expressions exps = populate_expressions(value);
+        if (not exps.size)
+            continue;
+
+        for (uint32_t s = 0; s < STATES; ++s)
+        {
+            std::vector<uint16_t> answers;
+            for (uint16_t i = 0; i < exps.size; ++i)
+                if (s % 4 == 0 or rng() % 3)
+                    answers.push_back(i);
+
+            const State state = random_state(exps, rng);
+            const PackedAnswers packed(exps, answers);
+
+            uint32_t expected = 0;
+            for (const auto &answer : answers)
+                expected += state.is_valid(exps, answer);
+
+            uint16_t scalar = count_valid_scalar(state.valid.data(), state.include, packed), fast = scalar;
+#if defined(__x86_64__)
+            if (__builtin_cpu_supports("avx2"))
+                fast = count_valid_avx2(state.valid.data(), state.include, packed);
+#endif
+            if (scalar != expected or fast != expected)
+            {
+                std::cerr << "value " << value << ": " << answers.size() << " answers, expected " << expected
+                          << " allowed, count_valid_scalar gives " << scalar << ", count_valid_avx2 gives "
+                          << fast << std::endl;
+                return 1;
+            }
+            ++checked;
+        }
+    }
+
+    std::cout << checked << " states match" << std::endl;
+    return 0;
+}
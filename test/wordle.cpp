@@ -0,0 +1,94 @@
+#include <fstream>
+#include <random>
+
+#include "wordle.hpp"
+
+// checks the vectorized result kernel against play() for every guess and answer
+// the five letter lists are read from the directory given as the first argument, and lists of the other
+// lengths are generated from a small alphabet, so that repeated letters are common
+
+// write n random words of L letters, one per line
+template <uint8_t L>
+bool write_words(const char *file, uint32_t n, std::mt19937 &rng)
+{
+    FILE *f = fopen(file, "w");
+    if (not f)
+        return false;
+
+    std::uniform_int_distribution<int> letter('a', 'h');
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        for (uint8_t j = 0; j < L; ++j)
+            fputc(letter(rng), f);
+        fputc('\n', f);
+    }
+    return fclose(f) == 0;
+}
+
+// compare both kernels over the full table of the lists, returns false on the first difference
+template <uint8_t L>
+bool check_patterns(const char *valid_file, const char *words_file)
+{
+    if (not initialize<L>(valid_file, words_file))
+        return false;
+
+#if defined(__x86_64__)
+    std::vector<Code<L>> fast(N_VALID), slow(N_VALID);
+    for (uint16_t i = 0; i < N_WORDS; ++i)
+    {
+        play_all_avx2<L>(fast.data(), get_word(i));
+        play_all_scalar<L>(slow.data(), get_word(i));
+        for (uint16_t j = 0; j < N_VALID; ++j)
+            if (fast[j] != slow[j])
+            {
+                std::cerr << "play_all_avx2 gives " << (int)fast[j] << " for " << std::string(get_word(i), L)
+                          << " against " << std::string(get_valid_word(j), L) << ", play gives "
+                          << (int)slow[j] << std::endl;
+                return false;
+            }
+    }
+#endif
+
+    std::cout << (int)L << " letters: " << N_WORDS << " x " << N_VALID << " results match" << std::endl;
+    return true;
+}
+
+// generate lists of L letter words, with an answer count which leaves a partial final pass, and check them
+template <uint8_t L>
+bool check_random(std::mt19937 &rng)
+{
+    const std::string words = "test_words_" + std::to_string(L), hidden = "test_hidden_" + std::to_string(L);
+    if (not write_words<L>(words.c_str(), 3001, rng))
+        return false;
+
+    // the answers are the first words of the guess list
+    std::ifstream in(words);
+    std::ofstream out(hidden);
+    std::string line;
+    for (uint32_t i = 0; i < 997 and std::getline(in, line); ++i)
+        out << line << "\n";
+    out.close();
+
+    return check_patterns<L>(hidden.c_str(), words.c_str());
+}
+
+int main(int argc, char **argv)
+{
+#if defined(__x86_64__)
+    if (not __builtin_cpu_supports("avx2"))
+#endif
+    {
+        std::cout << "No AVX2 kernel on this machine, skipping" << std::endl;
+        return 0;
+    }
+
+    const std::string dir = (argc > 1) ? argv[1] : ".";
+    std::mt19937 rng(1);
+    bool ok = check_patterns<5>((dir + "/words_hidden").c_str(), (dir + "/words_all").c_str());
+    ok = ok and check_random<4>(rng);
+    ok = ok and check_random<5>(rng);
+    ok = ok and check_random<6>(rng);
+    ok = ok and check_random<7>(rng);
+    ok = ok and check_random<8>(rng);
+    return (ok) ? 0 : 1;
+}
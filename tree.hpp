@@ -0,0 +1,248 @@
+#pragma once
+
+#include "wordle.hpp"
+
+// the whole strategy as a decision tree, built offline and queried without searching
+//
+// each node is the guess to play, with one child for every result seen other than a win
+// file layout, all in native byte order:
+// - TreeHeader
+// - `nodes` TreeNode, breadth first from the root, so each node's children are contiguous
+// - `edges` uint32_t child node indices, ordered by result code within each node
+// - `edges` uint16_t result codes, parallel to the child indices
+// a query reads one node per guess, and binary searches its codes for the result
+
+#define TREE_FILE "wordle_tree"
+#define TREE_MAGIC "WTREE\0\0"
+#define TREE_VERSION 1u
+#define NO_NODE U32MAX
+
+struct TreeHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t config;    // solver settings the tree was built with, as CACHE_CONFIG
+    uint64_t checksum;  // checksum of the word lists
+    uint32_t nodes;
+    uint32_t edges;
+};
+
+struct TreeNode
+{
+    uint16_t guess;
+    uint16_t children;  // number of children
+    uint32_t first;     // index of the first child's edge
+};
+
+// read-only view of a tree, either memory mapped from a file or over a built image
+class DecisionTree
+{
+public:
+    ~DecisionTree()
+    {
+        if (mapped)
+            munmap(mapped, size);
+    }
+
+    // use an image of a tree, which must outlive this
+    // returns false if it is malformed or was built with other word lists or settings
+    // every node is checked, so queries can follow the tree without bounds checks
+    template <uint8_t L>
+    bool open(const char *data, size_t bytes)
+    {
+        const auto *header = (const TreeHeader *)data;
+        if (bytes < sizeof(TreeHeader)                                  //
+            or memcmp(header->magic, TREE_MAGIC, sizeof(header->magic))  //
+            or header->version != TREE_VERSION                           //
+            or header->config != CACHE_CONFIG                            //
+            or header->checksum != WORDS_CHECKSUM                        //
+            or bytes != image_size(header->nodes, header->edges) or not header->nodes)
+            return false;
+
+        nodes = (const TreeNode *)(data + sizeof(TreeHeader));
+        children = (const uint32_t *)(nodes + header->nodes);
+        codes = (const uint16_t *)(children + header->edges);
+
+        // each node's edges must lie within the edge arrays, with increasing codes other than a win, and
+        // children numbered after the node, so every query ends
+        for (uint32_t k = 0; k < header->nodes; ++k)
+        {
+            const TreeNode &node = nodes[k];
+            if (node.guess >= N_WORDS or (uint64_t)node.first + node.children > header->edges)
+                return false;
+
+            for (uint32_t e = node.first; e < node.first + node.children; ++e)
+                if (codes[e] >= WIN<L> or (e > node.first and codes[e] <= codes[e - 1]) or children[e] <= k or
+                    children[e] >= header->nodes)
+                    return false;
+        }
+
+        n_nodes = header->nodes;
+        size = bytes;
+        return true;
+    }
+
+    // map a tree file, returns false if it is missing or unusable
+    template <uint8_t L>
+    bool load(const char *file)
+    {
+        size_t bytes;
+        char *data = map(file, &bytes);
+        if (not data)
+            return false;
+
+        if (not open<L>(data, bytes))
+        {
+            munmap(data, bytes);
+            return false;
+        }
+
+        mapped = data;
+        return true;
+    }
+
+    static uint32_t root()
+    {
+        return 0;
+    }
+
+    uint16_t guess(uint32_t node) const
+    {
+        return nodes[node].guess;
+    }
+
+    // node after the node's guess gets the result, or NO_NODE for a win or a result never seen
+    uint32_t next(uint32_t node, uint32_t code) const
+    {
+        const uint16_t *first = codes + nodes[node].first, *last = first + nodes[node].children;
+        const uint16_t *it = std::lower_bound(first, last, code);
+        return (it != last and *it == code) ? children[it - codes] : NO_NODE;
+    }
+
+    uint32_t count() const
+    {
+        return n_nodes;
+    }
+
+    // size of the image in bytes
+    size_t bytes() const
+    {
+        return size;
+    }
+
+    static size_t image_size(uint32_t nodes, uint32_t edges)
+    {
+        return sizeof(TreeHeader) + nodes * sizeof(TreeNode) + edges * (sizeof(uint32_t) + sizeof(uint16_t));
+    }
+
+private:
+    const TreeNode *nodes = nullptr;
+    const uint32_t *children = nullptr;
+    const uint16_t *codes = nullptr;
+    uint32_t n_nodes = 0;
+    size_t size = 0;
+    char *mapped = nullptr;  // owned mapping, if loaded from a file
+};
+
+// play every answer through find_guess, as evaluate() does, and return the image of the resulting tree
+template <uint8_t L>
+std::vector<char> build_tree()
+{
+    // search the games in parallel first, so that the walk below only reads the guess cache
+    evaluate<L>(false);
+
+    struct Node
+    {
+        uint16_t guess;
+        std::vector<std::pair<uint16_t, uint32_t>> children;  // result code and child, in order of discovery
+    };
+
+    std::vector<Node> built = {{find_guess(State<L>(), AnswerSet::all()), {}}};
+    Results result[L];
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        State<L> state;
+        AnswerSet answers = AnswerSet::all();
+        for (uint32_t node = 0;;)
+        {
+            const uint16_t index = built[node].guess;
+            const uint32_t code = get_pattern<L>(index, i);
+            if (code == WIN<L>)
+                break;
+
+            decode<L>(result, code);
+            state.apply(result, get_word(index));
+            filter_answers(answers, state, index, code);
+
+            const auto &children = built[node].children;
+            const auto it = std::find_if(children.begin(), children.end(),
+                                         [&](const auto &child) { return child.first == code; });
+            if (it != children.end())
+            {
+                node = it->second;
+                continue;
+            }
+
+            const uint32_t child = (uint32_t)built.size();
+            built[node].children.push_back({(uint16_t)code, child});
+            built.push_back({find_guess(state, answers), {}});
+            node = child;
+        }
+    }
+
+    // number the nodes breadth first, with each node's children in order of result
+    std::vector<uint32_t> order = {0}, number(built.size());
+    uint32_t edges = 0;
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        auto &children = built[order[k]].children;
+        std::sort(children.begin(), children.end());
+        for (const auto &child : children)
+        {
+            number[child.second] = (uint32_t)order.size();
+            order.push_back(child.second);
+        }
+        edges += (uint32_t)children.size();
+    }
+
+    const uint32_t n = (uint32_t)built.size();
+    std::vector<char> image(DecisionTree::image_size(n, edges));
+    TreeHeader header = {TREE_MAGIC, TREE_VERSION, CACHE_CONFIG, WORDS_CHECKSUM, n, edges};
+    memcpy(image.data(), &header, sizeof(header));
+
+    auto *nodes = (TreeNode *)(image.data() + sizeof(TreeHeader));
+    auto *children = (uint32_t *)(nodes + n);
+    auto *codes = (uint16_t *)(children + edges);
+    uint32_t edge = 0;
+    for (uint32_t k = 0; k < n; ++k)
+    {
+        const Node &node = built[order[k]];
+        nodes[k] = {node.guess, (uint16_t)node.children.size(), edge};
+        for (const auto &child : node.children)
+        {
+            codes[edge] = child.first;
+            children[edge++] = number[child.second];
+        }
+    }
+
+    return image;
+}
+
+// write a tree image to a file, returns false on failure
+inline bool save_tree(const std::vector<char> &image, const char *file)
+{
+    // write to a temporary and rename, as save_cache does, so a query never maps a partial tree
+    const std::string temp = std::string(file) + ".tmp." + std::to_string(getpid());
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (not f)
+        return false;
+
+    bool ok = fwrite(image.data(), 1, image.size(), f) == image.size();
+    ok &= fclose(f) == 0;
+    if (not ok or rename(temp.c_str(), file))
+    {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -1,458 +1,460 @@
-#include <fcntl.h>
-#include <iostream>
-#include <numeric>
-#include <stdio.h>
-#include <string.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <thread>
-#include <unordered_map>
-#include <vector>
-#include <array>
-
-// color codes
-#define BLK "\e[0;30m"
-#define GRN "\e[0;32m"
-#define YEL "\e[0;33m"
-#define RST "\e[0m"
-
-// possible wordle answers
-enum Results
+#include "absurdle.hpp"
+#include "boards.hpp"
+#include "optimal.hpp"
+#include "server.hpp"
+#include "speculate.hpp"
+#include "tree.hpp"
+#include "wordle.hpp"
+
+template <uint8_t L>
+void check_word(const char *hidden)
 {
-    BLACK = 0,
-    YELLOW = 1,
-    GREEN = 2,
-};
+    State<L> state;
+    Results result[L];
 
-// result to color code
-static const char *COLOR[3] = {BLK, YEL, GRN};
+    AnswerSet answers = AnswerSet::all();
+    Speculator<L> speculator;
 
-#define L 5u               // number of letters
-#define N_VALID 2315u      // number of valid answers
-#define N_WORDS 12972u     // number of valid guesses
-#define N_THREADS 8u       // number of threads to use
-#define ALL_26 0x03FFFFFF  // bitmask for 26
-#define U32MAX std::numeric_limits<uint32_t>::max()
-#define BLOCK (uint16_t)(N_WORDS / N_THREADS)
-#define MINMAX true
+    uint16_t answer = 0;
+    for (; answer < N_VALID; ++answer)
+        if (strncmp(hidden, get_valid_word(answer), L) == 0)
+            break;
 
-static uint32_t MASKS[255];                 // cached masks for each character
-#define MASK(c) (uint32_t)(1 << (c - 'a'))  // get bitmask for char
-#define GET_MASK(c) MASKS[(uint8_t)c]       // get the mask from the cache
+    if (answer == N_VALID)
+    {
+        std::cout << "Invalid word. Not in hidden list." << std::endl;
+        return;
+    }
 
-static char *VALID_WORDS;  // valid answers
-static char *WORDS;        // valid guesses
+    bool r = true;
+    for (uint8_t i = 0; i < 6 and r; ++i)
+    {
+        bool proven;
+        speculator.pause();
+        const uint16_t index = find_guess(state, answers, &proven);
+        const uint32_t code = get_pattern<L>(index, answer);
+        const char *guess = get_word(index);
 
-static uint32_t MASKED_ANSWERS[N_VALID][L];          // premasked answers
-static uint32_t MASKED_ANSWERS_WHOLE[N_VALID] = {};  // premasked answers
-static std::vector<uint16_t> ANSWERS;                // set of valid answers
+        // search the guesses which could follow while waiting for Enter
+        speculator.speculate({state, answers, index});
 
-// memory map a file
-static char *map(const char *file)
-{
-    int fd = open(file, O_RDONLY);
+        r = code != WIN<L>;
+        decode<L>(result, code);
 
-    struct stat s;
-    fstat(fd, &s);
+        print_move<L>(std::cout, result, guess, hidden);
+        std::cout << ((proven) ? "" : " (best found before the deadline)") << std::endl;
 
-    return (char *)mmap(0, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-}
+        state.apply(result, guess);
+        filter_answers(answers, state, index, code);
+        state.print(answers);
 
-// get the answer at word idx
-inline const char *get_valid_word(uint16_t idx)
-{
-    return &VALID_WORDS[6 * idx];
+        std::cout << "Press Enter" << std::endl;
+        std::cin.ignore();
+    }
 }
 
-// get the guess at word idx
-inline const char *get_word(uint16_t idx)
+template <uint8_t L>
+void interactive()
 {
-    return &WORDS[6 * idx];
-}
+    State<L> state;
+    Results result[L];
 
-// state which encodes known information
-// uses bitmasks to encode letter information - e.g., bit #3 corresponds to `c`
-struct State
-{
-    // bitmasks for valid characters at each position
-    std::array<uint32_t, L> valid = {ALL_26, ALL_26, ALL_26, ALL_26, ALL_26};
-    uint32_t include = 0;  // letters that must be in the word
+    AnswerSet answers = AnswerSet::all();
+    Speculator<L> speculator;
 
-    bool operator==(const State &other) const
-    {
-        return include == other.include and valid == other.valid;
-    }
+    std::cout << "After each guess, enter in result (string of " << (int)L << " of {b,y,g}, e.g., "
+              << std::string("bbygbbyg", L) << ")" << std::endl;
 
-    void apply(const Results result[L], const char *guess)
+    for (uint8_t i = 0; i < 6 and answers.count() > 1; ++i)
     {
-        uint32_t temp = 0;
-        for (uint8_t i = 0; i < L; ++i)
+        bool proven;
+        speculator.pause();
+        const uint16_t index = find_guess(state, answers, &proven);
+        const char *guess = get_word(index);
+        const char *note = (proven) ? "" : " (best found before the deadline)";
+        printf("Guess : %.*s%s\nResult: ", (int)L, guess, note);
+
+        // search the guesses for every result while the user types one in
+        speculator.speculate({state, answers, index});
+
+        while (true)
         {
-            const uint32_t m = GET_MASK(guess[i]);
-            if (result[i] == GREEN)  // must be this value
-                valid[i] = m;
+            std::string result_string;
+            std::getline(std::cin, result_string);
 
-            else if (result[i] == YELLOW)  // this position cannot be this value
-            {
-                valid[i] &= ~m;
-                include |= m;  // but this value must be elsewhere
-                temp |= m;     // keep track of prior yellow, as,
-            }
-            else
+            if (result_string.size() == L)
             {
-                if (not(temp & m))  // if yellow of this letter not seen,
-                {
-                    for (uint8_t j = 0; j < L; ++j)  // no position can be this value
-                        if (valid[j] - m)            // there are other values, not just this one
-                            valid[j] &= ~m;
-                }
-                else  // else just this position is not this letter
-                    valid[i] &= ~m;
+                uint8_t i = 0;
+                for (; i < L; ++i)
+                    if (result_string[i] == 'b')
+                        result[i] = BLACK;
+                    else if (result_string[i] == 'y')
+                        result[i] = YELLOW;
+                    else if (result_string[i] == 'g')
+                        result[i] = GREEN;
+                    else
+                        break;
+
+                if (i == L)
+                    break;
             }
+
+            std::cout << "Invalid Result. Try again." << std::endl;
         }
-    }
 
-    void print_mask(uint32_t mask) const
-    {
-        for (uint8_t j = 0; j < 26; ++j)
-            std::cout << ((mask & (1 << j)) ? (char)('a' + j) : '_');
+        state.apply(result, guess);
+        filter_answers(answers, state, index, encode<L>(result));
+        state.print(answers);
         std::cout << std::endl;
     }
 
-    void print() const
+    if (not answers.count())
     {
-        std::cout << N_WORDS << " / " << ANSWERS.size() << std::endl;
-        print_mask(include);
-        for (uint8_t i = 0; i < L; ++i)
-            print_mask(valid[i]);
-    }
-
-    inline bool is_valid(uint16_t index) const
-    {
-        const auto &mask = MASKED_ANSWERS[index];
-        return (valid[0] & mask[0])      //
-               and (valid[1] & mask[1])  //
-               and (valid[2] & mask[2])  //
-               and (valid[3] & mask[3])  //
-               and (valid[4] & mask[4])  //
-               and not(include - (include & MASKED_ANSWERS_WHOLE[index]));
-    }
-
-    void valid_answers()
-    {
-        uint16_t k = 0;
-        for (const auto &answer : ANSWERS)
-            if (is_valid(answer))
-                ANSWERS[k++] = answer;
-
-        ANSWERS.resize(k);
+        std::cout << "No answers match those results." << std::endl;
+        return;
     }
 
-    uint16_t num_answers() const
-    {
-        int k = 0;
-        for (const auto &answer : ANSWERS)
-            k += is_valid(answer);
+    printf("Answer: %.*s\n", (int)L, get_valid_word(answers.first()));
+}
 
-        return (uint16_t)k;
-    }
+// command line settings
+struct Options
+{
+    bool stats = false;
+    bool server = false;
+    bool speculate = false;  // search follow-up guesses between server queries
+    bool optimal = false;  // search for the tree with the fewest total guesses
+    bool absurdle = false;  // search for the shortest line against an adversarial host
+    bool strategy = false;  // --strategy was given
+    uint8_t boards = 1;    // boards played at once
+    uint32_t games = 1000;  // games played to evaluate more than one board
+    const char *socket = nullptr;  // unix socket path for the server, or stdin if not given
+    const char *tree_file = TREE_FILE;  // decision tree written by build-tree and read by query-tree
+    size_t cache_size = 0;         // most entries kept by each in-memory cache, 0 for no limit
+    uint8_t length = 0;  // letters per word, 0 to take it from the first hidden word
+    const char *valid_file = "words_hidden";
+    const char *words_file = "words_all";
+    std::vector<const char *> args;  // positional arguments
 };
 
-bool play(Results result[L], const char *guess, const char *hidden)
+// print the next guess from the tree after the results given so far, without searching
+template <uint8_t L>
+int query_tree(const Options &options)
 {
-    bool r = true;
-    bool done[L];
-
-    for (uint8_t i = 0; i < L; ++i)
+    DecisionTree tree;
+    if (not tree.load<L>(options.tree_file))
     {
-        r &= (done[i] = guess[i] == hidden[i]);
-        result[i] = (done[i]) ? GREEN : BLACK;
+        std::cerr << "Cannot load " << options.tree_file << ", or it was built with other settings"
+                  << std::endl;
+        return 1;
     }
 
-    if (not r)
-        for (uint8_t i = 0; i < L; ++i)
-            if (result[i] != GREEN)
-                for (uint8_t j = 0; j < L; ++j)
-                    if (guess[i] == hidden[j] and not done[j] and i != j)
-                    {
-                        done[j] = true;
-                        result[i] = YELLOW;
-                        break;
-                    }
+    Results result[L];
+    uint32_t node = tree.root();
+    for (size_t i = 1; i < options.args.size(); ++i)
+    {
+        const char *feedback = options.args[i];
+        uint8_t k = 0;
+        for (; k < L and feedback[k]; ++k)
+            if (feedback[k] == 'b')
+                result[k] = BLACK;
+            else if (feedback[k] == 'y')
+                result[k] = YELLOW;
+            else if (feedback[k] == 'g')
+                result[k] = GREEN;
+            else
+                break;
 
-    return r;
-}
+        if (k != L or feedback[k])
+        {
+            std::cout << "Invalid result " << feedback << std::endl;
+            return 1;
+        }
 
-void print_move(Results result[L], const char *guess, const char *hidden = nullptr)
-{
-    for (uint8_t i = 0; i < L; ++i)
-        std::cout << COLOR[result[i]] << guess[i];
+        const uint32_t code = encode<L>(result);
+        if (code == WIN<L>)
+        {
+            std::cout << "Solved" << std::endl;
+            return 0;
+        }
 
-    std::cout << RST;
-    if (hidden)
-    {
-        std::cout << " / ";
-        for (uint8_t i = 0; i < L; ++i)
-            std::cout << hidden[i];
+        if ((node = tree.next(node, code)) == NO_NODE)
+        {
+            std::cout << "No answers match those results" << std::endl;
+            return 1;
+        }
     }
+
+    printf("%.*s\n", (int)L, get_word(tree.guess(node)));
+    return 0;
 }
 
-class StateHash
+template <uint8_t L>
+int run(const Options &options)
 {
-public:
-    std::size_t operator()(const State &state) const
-    {
-        std::size_t r = state.include;
-        for (uint8_t i = 0; i < L; ++i)
-            r += state.valid[i];
-        return r;
-    }
-};
+    // queries read only the word lists and the tree, without building any of the search's tables
+    if (not options.args.empty() and strcmp(options.args[0], "query-tree") == 0)
+        return (load_word_lists<L>(options.valid_file, options.words_file)) ? query_tree<L>(options) : 1;
 
-struct Guess
-{
-    uint32_t max{U32MAX};
-    uint32_t avg{U32MAX};
-    uint32_t best{U32MAX};
-    uint16_t word{0};
+    if (not initialize<L>(options.valid_file, options.words_file))
+        return 1;
 
-    bool operator<(const Guess &other) const
+    // Load previously computed guesses
+    load_cache<L>();
+    if (options.cache_size)
     {
-        if (MINMAX and max < other.max)
-            return true;
-        if (MINMAX and max > other.max)
-            return false;
-
-        if (avg < other.avg)
-            return true;
-        if (avg > other.avg)
-            return false;
-
-        if (MINMAX and best < other.best)
-            return true;
-        if (MINMAX and best > other.best)
-            return false;
-
-        return word < other.word;
+        guess_cache.set_capacity(options.cache_size);
+        OPTIMAL_MEMO.table.set_capacity(options.cache_size);
+        ABSURDLE_MEMO.table.set_capacity(options.cache_size);
+        board_cache.set_capacity(options.cache_size);
     }
 
-    void add_score(uint32_t score)
+    if (options.server)
     {
-        avg += score;
-        if (MINMAX)
+        Server<L> server(options.speculate);
+        if (options.socket)
         {
-            max = std::max(score, max);
-            best = std::min(score, best);
+            if (not server.serve_socket(options.socket))
+                return 1;
         }
-    }
-};
-
-const char *find_guess(const State &state)
-{
-    if (ANSWERS.size() == 1)  // only one word left
-        return get_valid_word(ANSWERS[0]);
+        else
+            server.serve_stdin();
 
-    // lookup result from cache if the best play for this state was already computed
-    static std::unordered_map<const State, uint16_t, StateHash> guess_cache;
-    const auto &it = guess_cache.find(state);
-    if (it != guess_cache.end())
-        return get_word(it->second);
+        std::cerr << server.latency.json() << std::endl;
+    }
 
-    Guess guesses[N_THREADS];
-    std::thread threads[N_THREADS];
+    else if (options.boards > 1)
+    {
+        // each board of a random game has a different hidden word
+        if (options.args.empty() and options.boards > N_VALID)
+        {
+            std::cerr << "Cannot draw " << (int)options.boards << " different hidden words from " << N_VALID
+                      << " answers" << std::endl;
+            return 1;
+        }
 
-    for (uint8_t id = 0; id < N_THREADS; ++id)
-        threads[id] = std::thread(
-            [&, id]()
+        if (options.args.empty())
+            evaluate_boards<L>(options.boards, options.games);
+        else
+        {
+            std::vector<uint16_t> hidden;
+            for (const char *word : options.args)
             {
-                Results result[L];
-                const uint16_t start = (uint16_t)(BLOCK * id);
-                const uint16_t end =
-                    (uint16_t)(start + BLOCK + ((id == N_THREADS - 1) ? N_WORDS % N_THREADS : 0));
-                for (uint16_t i = start; i < end; ++i)
+                uint16_t answer = 0;
+                while (answer < N_VALID and strncmp(word, get_valid_word(answer), L) != 0)
+                    ++answer;
+                if (answer == N_VALID or strlen(word) != L)
                 {
-                    Guess score = {0, 0, U32MAX, i};
-                    const char *guess = get_word(i);
-                    for (const auto &answer : ANSWERS)
-                    {
-                        play(result, guess, get_valid_word(answer));
-
-                        State next = state;
-                        next.apply(result, guess);
-                        score.add_score(next.num_answers());
-
-                        if (score.max > guesses[id].max)
-                            break;
-                    }
-
-                    if (score < guesses[id])
-                        guesses[id] = score;
+                    std::cout << "Invalid word " << word << ". Not in hidden list." << std::endl;
+                    return 1;
                 }
-            });
-
-    for (auto &thread : threads)
-        thread.join();
-
-    for (uint8_t i = 1; i < N_THREADS; ++i)
-        if (guesses[i] < guesses[0])
-            guesses[0] = guesses[i];
-
-    guess_cache.emplace(state, guesses[0].word);
-    return get_word(guesses[0].word);
-}
-
-void evaluate()
-{
-    float avg = 0;
-    Results result[L];
-    uint16_t totals[7] = {};
+                hidden.push_back(answer);
+            }
+            check_boards<L>(hidden);
+        }
+    }
 
-    for (uint16_t i = 0; i < N_VALID; ++i)
+    else if (options.absurdle)
     {
-        State state;
-        const char *hidden = get_valid_word(i);
-
-        int j = 0;
-        bool r = true;
-        for (; j < 6 and r; ++j)
+        // any positional arguments are opening guesses
+        std::vector<uint16_t> opening;
+        for (const char *word : options.args)
         {
-            const char *guess = find_guess(state);
-            r = not play(result, guess, hidden);
-            print_move(result, guess);
-            std::cout << " ";
+            uint16_t index = 0;
+            while (index < N_WORDS and strncmp(word, get_word(index), L) != 0)
+                ++index;
+            if (index == N_WORDS or strlen(word) != L)
+            {
+                std::cout << "Invalid word " << word << ". Not in guess list." << std::endl;
+                return 1;
+            }
+            opening.push_back(index);
+        }
+        evaluate_absurdle<L>(opening);
+    }
 
-            state.apply(result, guess);
-            state.valid_answers();
+    else if (not options.args.empty() and strcmp(options.args[0], "build-tree") == 0)
+    {
+        const std::vector<char> image = build_tree<L>();
+        if (not save_tree(image, options.tree_file))
+        {
+            std::cerr << "Cannot write " << options.tree_file << std::endl;
+            return 1;
         }
 
-        j += r;
-        totals[j - 1]++;
+        DecisionTree tree;
+        tree.open<L>(image.data(), image.size());
+        std::cout << "Wrote " << tree.count() << " nodes in " << tree.bytes() << " bytes to "
+                  << options.tree_file << std::endl;
+    }
 
-        if (not r)
-            std::cout << j << std::endl;
+    else if (options.args.size() == 1)
+        if (strncmp(options.args[0], "?", 1) == 0)
+            interactive<L>();
         else
-            printf("%.5s\n", hidden);
+            check_word<L>(options.args[0]);
 
-        avg += (float)j;
+    else if (options.optimal)
+        evaluate_optimal<L>();
 
-        ANSWERS.resize(N_VALID);
-        std::iota(ANSWERS.begin(), ANSWERS.end(), 0);
-    }
+    else
+        evaluate<L>();
 
-    for (uint8_t i = 0; i < 7; ++i)
-        std::cout << totals[i] << " ";
-    std::cout << "Avg: " << avg / N_VALID << std::endl;
+    save_cache<L>();
+
+    if (options.stats)
+        print_stats(std::cerr,
+                    {{"guess_cache", guess_cache.stats()},
+                     {"optimal_memo", OPTIMAL_MEMO.table.stats()},
+                     {"absurdle_memo", ABSURDLE_MEMO.table.stats()},
+                     {"board_cache", board_cache.stats()}});
+
+    return 0;
 }
 
-void check_word(const char *hidden)
+int main(int argc, char **argv)
 {
-    State state;
-    Results result[L];
-
-    bool found = false;
-    for (uint16_t i = 0; i < N_VALID and not found; ++i)
-        found |= strncmp(hidden, get_valid_word(i), L) == 0;
+    // Separate flags from positional arguments
+    Options options;
+    for (int i = 1; i < argc; ++i)
+        if (strcmp(argv[i], "--stats") == 0)
+            options.stats = true;
+        else if (strcmp(argv[i], "--hidden") == 0 and i + 1 < argc)
+            options.valid_file = argv[++i];
+        else if (strcmp(argv[i], "--words") == 0 and i + 1 < argc)
+            options.words_file = argv[++i];
+        else if (strcmp(argv[i], "--strategy") == 0 and i + 1 < argc)
+        {
+            const char *name = argv[++i];
+            options.strategy = true;
+            if (strcmp(name, "expected") == 0)
+                STRATEGY = EXPECTED;
+            else if (strcmp(name, "minimax") == 0)
+                STRATEGY = MINIMAX;
+            else if (strcmp(name, "entropy") == 0)
+                STRATEGY = ENTROPY;
+            else
+            {
+                std::cerr << "Unknown strategy " << name << ", expected minimax, expected or entropy"
+                          << std::endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--boards") == 0 and i + 1 < argc)
+            options.boards = (uint8_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--games") == 0 and i + 1 < argc)
+            options.games = (uint32_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--hard") == 0)
+            HARD = true;
+        else if (strcmp(argv[i], "--deadline") == 0 and i + 1 < argc)
+            DEADLINE_MS = (uint32_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--optimal") == 0)
+            options.optimal = true;
+        else if (strcmp(argv[i], "--absurdle") == 0)
+            options.absurdle = true;
+        else if (strcmp(argv[i], "--server") == 0)
+            options.server = true;
+        else if (strcmp(argv[i], "--speculate") == 0)
+            options.speculate = true;
+        else if (strcmp(argv[i], "--socket") == 0 and i + 1 < argc)
+            options.server = true, options.socket = argv[++i];
+        else if (strcmp(argv[i], "--cache-size") == 0 and i + 1 < argc)
+            options.cache_size = (size_t)atoll(argv[++i]);
+        else if (strcmp(argv[i], "--tree") == 0 and i + 1 < argc)
+            options.tree_file = argv[++i];
+        else if (strcmp(argv[i], "--length") == 0 and i + 1 < argc)
+            options.length = (uint8_t)atoi(argv[++i]);
+        else
+            options.args.push_back(argv[i]);
 
-    if (not found)
+    if (HARD and options.optimal)
     {
-        std::cout << "Invalid word. Not in hidden list." << std::endl;
-        return;
+        std::cerr << "--hard cannot be combined with --optimal" << std::endl;
+        return 1;
     }
 
-    bool r = true;
-    for (uint8_t i = 0; i < 6 and r; ++i)
+    // the optimal and Absurdle searches have their own objectives, which no strategy changes
+    if (options.strategy and (options.optimal or options.absurdle))
     {
-        const char *guess = find_guess(state);
-        r = not play(result, guess, hidden);
-
-        print_move(result, guess, hidden);
-        std::cout << std::endl;
-
-        state.apply(result, guess);
-        state.print();
-        state.valid_answers();
-
-        std::cout << "Press Enter" << std::endl;
-        std::cin.ignore();
+        std::cerr << "--strategy cannot be combined with --optimal or --absurdle" << std::endl;
+        return 1;
     }
-}
-
-void interactive()
-{
-    State state;
-    Results result[L];
-
-    std::cout << "After each guess, enter in result (string of 5 of {b,y,g}, e.g., bbygb)" << std::endl;
 
-    for (uint8_t i = 0; i < 6 and ANSWERS.size() > 1; ++i)
+    // the optimal tree is only played by evaluating every answer
+    if (options.optimal and (options.server or not options.args.empty()))
     {
-        const char *guess = find_guess(state);
-        printf("Guess : %.5s\nResult: ", guess);
-
-        while (true)
-        {
-            std::string result_string;
-            std::getline(std::cin, result_string);
-
-            if (result_string.size() == L)
-            {
-                uint8_t i = 0;
-                for (; i < L; ++i)
-                    if (result_string[i] == 'b')
-                        result[i] = BLACK;
-                    else if (result_string[i] == 'y')
-                        result[i] = YELLOW;
-                    else if (result_string[i] == 'g')
-                        result[i] = GREEN;
-                    else
-                        break;
-
-                if (i == L)
-                    break;
-            }
+        std::cerr << "--optimal cannot be combined with --server, a word, ?, build-tree or query-tree"
+                  << std::endl;
+        return 1;
+    }
 
-            std::cout << "Invalid Result. Try again." << std::endl;
-        }
+    if (options.speculate and not options.server)
+    {
+        std::cerr << "--speculate only applies to --server or --socket" << std::endl;
+        return 1;
+    }
 
-        state.apply(result, guess);
-        state.valid_answers();
-        state.print();
-        std::cout << std::endl;
+    if (options.absurdle and (HARD or options.optimal or options.server or options.boards > 1))
+    {
+        std::cerr << "--absurdle cannot be combined with --hard, --optimal, --server or --boards"
+                  << std::endl;
+        return 1;
     }
 
-    printf("Answer: %.5s\n", get_word(ANSWERS[0]));
-}
+    if (DEADLINE_MS and not options.args.empty() and strcmp(options.args[0], "build-tree") == 0)
+    {
+        std::cerr << "--deadline cannot be combined with build-tree, which needs every guess searched in full"
+                  << std::endl;
+        return 1;
+    }
 
-int main(int argc, char **argv)
-{
-    // Iniitalize word files
-    VALID_WORDS = map("words_hidden");
-    WORDS = map("words_all");
+    if (DEADLINE_MS and (options.optimal or options.absurdle or options.boards > 1))
+    {
+        std::cerr << "--deadline cannot be combined with --optimal, --absurdle or --boards" << std::endl;
+        return 1;
+    }
 
-    // Fill in valid answer set
-    ANSWERS.resize(N_VALID);
-    std::iota(ANSWERS.begin(), ANSWERS.end(), 0);
+    if (options.boards < 1 or options.boards > MAX_BOARDS or (options.boards > 1 and not options.games))
+    {
+        std::cerr << "Expected 1 to " << MAX_BOARDS << " boards and at least one game" << std::endl;
+        return 1;
+    }
 
-    // Initialize mask cache
-    for (char c = 'a'; c <= 'z'; ++c)
-        GET_MASK(c) = MASK(c);
+    if (options.boards > 1 and (HARD or options.optimal or options.server or options.strategy))
+    {
+        std::cerr << "--boards cannot be combined with --hard, --optimal, --server or --strategy"
+                  << std::endl;
+        return 1;
+    }
 
-    // Initialize answer mask cache
-    for (uint16_t i = 0; i < N_VALID; ++i)
+    if (options.boards > 1 and not options.args.empty() and options.args.size() != options.boards)
     {
-        const char *word = get_valid_word(i);
-        for (uint8_t j = 0; j < L; ++j)
-            MASKED_ANSWERS_WHOLE[i] |= (MASKED_ANSWERS[i][j] = GET_MASK(word[j]));
+        std::cerr << "Expected " << (int)options.boards << " hidden words, one for each board" << std::endl;
+        return 1;
     }
 
-    if (argc == 2)
-        if (strncmp(argv[1], "?", 1) == 0)
-            interactive();
-        else
-            check_word(argv[1]);
+    if (not options.length and not (options.length = word_length(options.valid_file)))
+    {
+        std::cerr << "Cannot read word list " << options.valid_file << std::endl;
+        return 1;
+    }
 
-    else
-        evaluate();
+    // Dispatch to the specialization for this word length
+    switch (options.length)
+    {
+        case 4:
+            return run<4>(options);
+        case 5:
+            return run<5>(options);
+        case 6:
+            return run<6>(options);
+        case 7:
+            return run<7>(options);
+        case 8:
+            return run<8>(options);
+    }
 
-    return 0;
+    std::cerr << "Unsupported word length " << (int)options.length << ", expected " << MIN_LENGTH << " to "
+              << MAX_LENGTH << " letters" << std::endl;
+    return 1;
 }
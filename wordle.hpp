@@ -0,0 +1,1359 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fcntl.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <numeric>
+#include <stdio.h>
+#include <string.h>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include <array>
+
+#include "cache.hpp"
+#include "pool.hpp"
+#include "stats.hpp"
+
+// color codes
+#define BLK "\e[0;30m"
+#define GRN "\e[0;32m"
+#define YEL "\e[0;33m"
+#define RST "\e[0m"
+
+// possible wordle answers
+enum Results
+{
+    BLACK = 0,
+    YELLOW = 1,
+    GREEN = 2,
+};
+
+// result to color code
+static const char *COLOR[3] = {BLK, YEL, GRN};
+
+#define N_LANES 32u        // answers per vectorized result pass
+#define ALL_26 0x03FFFFFF  // bitmask for 26
+#define U32MAX std::numeric_limits<uint32_t>::max()
+#define U64MAX std::numeric_limits<uint64_t>::max()
+
+// how guesses are ranked, from the histogram of results over the remaining answers
+// values are stored in the cache file, EXPECTED and MINIMAX match the former MINMAX false and true
+enum Strategy : uint8_t
+{
+    EXPECTED = 0,  // least expected number of remaining answers
+    MINIMAX = 1,   // least largest bucket, then as EXPECTED
+    ENTROPY = 2,   // most information
+};
+
+static Strategy STRATEGY = MINIMAX;
+static bool HARD = false;  // only guess words allowed by everything known so far
+static uint32_t DEADLINE_MS = 0;  // milliseconds allowed for each search, 0 for no limit
+
+// the engine is specialized at compile time on L, the number of letters
+// supported lengths, each of which is instantiated by the runtime dispatcher in wordle.cpp
+#define MIN_LENGTH 4
+#define MAX_LENGTH 8
+
+// number of possible results for a guess (3^L)
+constexpr uint16_t pow3(uint8_t n)
+{
+    return (n) ? (uint16_t)(3 * pow3((uint8_t)(n - 1))) : 1;
+}
+
+template <uint8_t L>
+constexpr uint16_t N_PATTERNS = pow3(L);
+
+// result code for all green
+template <uint8_t L>
+constexpr uint16_t WIN = N_PATTERNS<L> - 1;
+
+// smallest type which holds a result code
+template <uint8_t L>
+using Code = std::conditional_t<(N_PATTERNS<L> <= 256), uint8_t, uint16_t>;
+
+// sizes of the word lists, set when they are loaded
+static uint16_t N_VALID;   // number of valid answers
+static uint16_t N_WORDS;   // number of valid guesses
+static uint16_t N_BLOCKS;  // number of 64-bit blocks in an answer set
+static uint32_t N_PADDED;  // number of answers rounded up to a whole vectorized pass
+
+static uint32_t MASKS[255];                 // cached masks for each character
+#define MASK(c) (uint32_t)(1 << (c - 'a'))  // get bitmask for char
+#define GET_MASK(c) MASKS[(uint8_t)c]       // get the mask from the cache
+
+// set of answers, one bit per answer
+// operations are simple loops over the blocks, which the compiler vectorizes for the target
+struct AnswerSet
+{
+    std::vector<uint64_t> bits = std::vector<uint64_t>(N_BLOCKS);
+
+    // whole blocks at a time, with the answers past N_VALID masked off the last
+    static AnswerSet all()
+    {
+        AnswerSet r;
+        std::fill(r.bits.begin(), r.bits.end(), ~0ull);
+        if (N_VALID % 64)
+            r.bits.back() = (1ull << (N_VALID % 64)) - 1;
+        return r;
+    }
+
+    bool operator==(const AnswerSet &other) const
+    {
+        return bits == other.bits;
+    }
+
+    Fingerprint fingerprint() const
+    {
+        return ::fingerprint(bits.data(), bits.size() * sizeof(uint64_t));
+    }
+
+    inline bool test(uint16_t i) const
+    {
+        return bits[i / 64] & (1ull << (i % 64));
+    }
+
+    inline void set(uint16_t i)
+    {
+        bits[i / 64] |= 1ull << (i % 64);
+    }
+
+    inline void reset(uint16_t i)
+    {
+        bits[i / 64] &= ~(1ull << (i % 64));
+    }
+
+    AnswerSet &operator&=(const AnswerSet &other)
+    {
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            bits[i] &= other.bits[i];
+        return *this;
+    }
+
+    AnswerSet &operator|=(const AnswerSet &other)
+    {
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            bits[i] |= other.bits[i];
+        return *this;
+    }
+
+    // remove all answers in other
+    AnswerSet &remove(const AnswerSet &other)
+    {
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            bits[i] &= ~other.bits[i];
+        return *this;
+    }
+
+    uint16_t count() const
+    {
+        uint16_t k = 0;
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            k = (uint16_t)(k + __builtin_popcountll(bits[i]));
+        return k;
+    }
+
+    // index of the first answer in the set
+    uint16_t first() const
+    {
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            if (bits[i])
+                return (uint16_t)(i * 64 + __builtin_ctzll(bits[i]));
+        return N_VALID;
+    }
+
+    // call fn(answer) on each answer in the set, in order
+    template <typename F>
+    void for_each(F &&fn) const
+    {
+        for (uint16_t i = 0; i < N_BLOCKS; ++i)
+            for (uint64_t b = bits[i]; b; b &= b - 1)
+                fn((uint16_t)(i * 64 + __builtin_ctzll(b)));
+    }
+};
+
+// a memory mapped list of words, one per line
+struct WordList
+{
+    char *data = nullptr;
+    size_t bytes = 0;       // size of the file
+    size_t stride = 0;      // bytes per line, including the line ending
+    uint16_t size = 0;      // number of words
+};
+
+static WordList VALID_WORDS;  // valid answers
+static WordList WORDS;        // valid guesses
+
+template <uint8_t L>
+static std::vector<std::array<uint32_t, L>> MASKED_ANSWERS;  // premasked answers
+static std::vector<uint32_t> MASKED_ANSWERS_WHOLE;          // premasked answers
+template <uint8_t L>
+static std::vector<std::array<uint32_t, L>> MASKED_WORDS;  // premasked guesses, for hard mode
+static std::vector<uint32_t> MASKED_WORDS_WHOLE;          // premasked guesses
+static std::vector<uint16_t> ALL_GUESSES;                 // index of every guess
+static std::vector<uint16_t> ANSWER_GUESS;                  // guess index of each answer
+template <uint8_t L>
+static std::array<std::vector<uint8_t>, L> ANSWER_LETTERS;  // letters of each answer by position
+
+template <uint8_t L>
+static std::array<std::array<AnswerSet, 26>, L> ANSWERS_AT;  // answers with each letter at each position
+static AnswerSet ANSWERS_WITH[26];                           // answers which include each letter
+
+static ThreadPool POOL;  // worker threads for searching
+
+// counters for find_guess, see stats.hpp
+struct SearchStats
+{
+    Counter cache_hits;
+    Counter cache_misses;
+    Counter candidates_evaluated;  // guesses scored over all remaining answers
+    Counter candidates_pruned;     // guesses abandoned once worse than the best so far
+    Counter searches_timed_out;    // searches which reached the deadline before scoring every guess
+    Counter speculated;            // searches run in the background while waiting for a result
+};
+
+static SearchStats STATS;
+
+// precomputed result code of each guess against each answer, one row of N_VALID per guess
+template <uint8_t L>
+static std::vector<Code<L>> PATTERNS;
+
+// memory map a file, returns nullptr if the file cannot be mapped
+static char *map(const char *file, size_t *size = nullptr)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat s;
+    fstat(fd, &s);
+    if (size)
+        *size = (size_t)s.st_size;
+
+    void *data = (s.st_size) ? mmap(0, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    return (data == MAP_FAILED) ? nullptr : (char *)data;
+}
+
+// FNV-1a hash of a block of memory
+static uint64_t checksum(const char *data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ (uint8_t)data[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+// length of the first word in a word list, or 0 if it cannot be read
+uint8_t word_length(const char *file)
+{
+    size_t bytes;
+    char *data = map(file, &bytes);
+    if (not data)
+        return 0;
+
+    uint8_t n = 0;
+    while (n < bytes and n < 255 and 'a' <= data[n] and data[n] <= 'z')
+        ++n;
+
+    munmap(data, bytes);
+    return n;
+}
+
+// map a word list and check that every line is a word of `length` lowercase letters
+// line endings may be either \n or \r\n, and the last line may have none
+bool load_words(const char *file, WordList &list, uint8_t length)
+{
+    list.data = map(file, &list.bytes);
+    if (not list.data)
+    {
+        std::cerr << "Cannot read word list " << file << std::endl;
+        return false;
+    }
+
+    const char *newline = (const char *)memchr(list.data, '\n', list.bytes);
+    list.stride = (newline) ? (size_t)(newline - list.data) + 1 : list.bytes;
+
+    const size_t n = (list.bytes + list.stride - 1) / list.stride;
+    if (n > std::numeric_limits<uint16_t>::max())
+    {
+        std::cerr << file << ": too many words, at most " << std::numeric_limits<uint16_t>::max()
+                  << " are supported" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char *line = list.data + i * list.stride;
+        const size_t size = std::min(list.stride, list.bytes - i * list.stride);
+
+        bool ok = size >= length;
+        for (size_t j = 0; ok and j < length; ++j)
+            ok = 'a' <= line[j] and line[j] <= 'z';
+        for (size_t j = length; ok and j < size; ++j)
+            ok = line[j] == '\r' or line[j] == '\n';
+
+        if (not ok)
+        {
+            std::cerr << file << ":" << i + 1 << ": expected a word of " << (int)length
+                      << " lowercase letters" << std::endl;
+            return false;
+        }
+    }
+
+    list.size = (uint16_t)n;
+    return true;
+}
+
+// get the answer at word idx
+inline const char *get_valid_word(uint16_t idx)
+{
+    return &VALID_WORDS.data[VALID_WORDS.stride * idx];
+}
+
+// get the guess at word idx
+inline const char *get_word(uint16_t idx)
+{
+    return &WORDS.data[WORDS.stride * idx];
+}
+
+// state which encodes known information
+// uses bitmasks to encode letter information - e.g., bit #3 corresponds to `c`
+template <uint8_t L>
+struct State
+{
+    // bitmasks for valid characters at each position
+    std::array<uint32_t, L> valid;
+    uint32_t include = 0;  // letters that must be in the word
+
+    State()
+    {
+        valid.fill(ALL_26);
+    }
+
+    bool operator==(const State &other) const
+    {
+        return include == other.include and valid == other.valid;
+    }
+
+    bool operator<(const State &other) const
+    {
+        return (include != other.include) ? include < other.include : valid < other.valid;
+    }
+
+    void apply(const Results result[L], const char *guess)
+    {
+        uint32_t temp = 0;
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            const uint32_t m = GET_MASK(guess[i]);
+            if (result[i] == GREEN)  // must be this value
+                valid[i] = m;
+
+            else if (result[i] == YELLOW)  // this position cannot be this value
+            {
+                valid[i] &= ~m;
+                include |= m;  // but this value must be elsewhere
+                temp |= m;     // keep track of prior yellow, as,
+            }
+            else
+            {
+                if (not(temp & m))  // if yellow of this letter not seen,
+                {
+                    for (uint8_t j = 0; j < L; ++j)  // no position can be this value
+                        if (valid[j] - m)            // there are other values, not just this one
+                            valid[j] &= ~m;
+                }
+                else  // else just this position is not this letter
+                    valid[i] &= ~m;
+            }
+        }
+    }
+
+    void print_mask(uint32_t mask) const
+    {
+        for (uint8_t j = 0; j < 26; ++j)
+            std::cout << ((mask & (1 << j)) ? (char)('a' + j) : '_');
+        std::cout << std::endl;
+    }
+
+    void print(const AnswerSet &answers) const
+    {
+        std::cout << N_WORDS << " / " << answers.count() << std::endl;
+        print_mask(include);
+        for (uint8_t i = 0; i < L; ++i)
+            print_mask(valid[i]);
+    }
+
+    inline bool is_valid(uint16_t index) const
+    {
+        // L is a constant, so this is fully unrolled
+        const auto &mask = MASKED_ANSWERS<L>[index];
+        bool r = not(include - (include & MASKED_ANSWERS_WHOLE[index]));
+        for (uint8_t i = 0; i < L; ++i)
+            r &= (valid[i] & mask[i]) != 0;
+        return r;
+    }
+
+    // as is_valid, for a guess
+    inline bool is_legal(uint16_t guess) const
+    {
+        const auto &mask = MASKED_WORDS<L>[guess];
+        bool r = not(include - (include & MASKED_WORDS_WHOLE[guess]));
+        for (uint8_t i = 0; i < L; ++i)
+            r &= (valid[i] & mask[i]) != 0;
+        return r;
+    }
+
+    // guesses allowed in hard mode, those which could still be the answer by this state
+    std::vector<uint16_t> legal_guesses() const
+    {
+        std::vector<uint16_t> guesses;
+        guesses.reserve(N_WORDS);
+        for (uint16_t i = 0; i < N_WORDS; ++i)
+            if (is_legal(i))
+                guesses.push_back(i);
+        return guesses;
+    }
+
+    // call fn(b, bits) with the answers allowed by this state in each block b, without building any sets
+    template <typename F>
+    void for_each_block(F &&fn) const
+    {
+        // each position takes whichever of its allowed or excluded letters needs fewer sets
+        const uint64_t *sets[L][13];
+        uint8_t n_sets[L];
+        bool exclude[L];
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            if (valid[i] == ALL_26)
+                continue;
+
+            const uint32_t excluded = ALL_26 & ~valid[i];
+            exclude[n] = __builtin_popcount(valid[i]) >= __builtin_popcount(excluded);
+            n_sets[n] = 0;
+            for (uint32_t m = (exclude[n]) ? excluded : valid[i]; m; m &= m - 1)
+                sets[n][n_sets[n]++] = ANSWERS_AT<L>[i][__builtin_ctz(m)].bits.data();
+            ++n;
+        }
+
+        const uint64_t *with[26];
+        uint8_t n_with = 0;
+        for (uint32_t m = include; m; m &= m - 1)
+            with[n_with++] = ANSWERS_WITH[__builtin_ctz(m)].bits.data();
+
+        // excluded letters set the bits past N_VALID, which are masked off the last block
+        const uint64_t tail = (N_VALID % 64) ? (1ull << (N_VALID % 64)) - 1 : ~0ull;
+        for (uint16_t b = 0; b < N_BLOCKS; ++b)
+        {
+            uint64_t r = (b + 1 == N_BLOCKS) ? tail : ~0ull;
+            for (uint8_t k = 0; k < n; ++k)
+            {
+                uint64_t m = 0;
+                for (uint8_t j = 0; j < n_sets[k]; ++j)
+                    m |= sets[k][j][b];
+                r &= (exclude[k]) ? ~m : m;
+            }
+            for (uint8_t j = 0; j < n_with; ++j)
+                r &= with[j][b];
+            fn(b, r);
+        }
+    }
+
+    // set of all answers allowed by this state
+    AnswerSet answers() const
+    {
+        AnswerSet r;
+        for_each_block([&](uint16_t b, uint64_t bits) { r.bits[b] = bits; });
+        return r;
+    }
+
+    void valid_answers(AnswerSet &answers) const
+    {
+        for_each_block([&](uint16_t b, uint64_t bits) { answers.bits[b] &= bits; });
+    }
+
+    uint16_t num_answers(const AnswerSet &answers) const
+    {
+        uint16_t k = 0;
+        for_each_block([&](uint16_t b, uint64_t bits)
+                       { k = (uint16_t)(k + __builtin_popcountll(bits & answers.bits[b])); });
+        return k;
+    }
+};
+
+template <uint8_t L>
+bool play(Results result[L], const char *guess, const char *hidden)
+{
+    bool r = true;
+    bool done[L];
+
+    for (uint8_t i = 0; i < L; ++i)
+    {
+        r &= (done[i] = guess[i] == hidden[i]);
+        result[i] = (done[i]) ? GREEN : BLACK;
+    }
+
+    if (not r)
+        for (uint8_t i = 0; i < L; ++i)
+            if (result[i] != GREEN)
+                for (uint8_t j = 0; j < L; ++j)
+                    if (guess[i] == hidden[j] and not done[j] and i != j)
+                    {
+                        done[j] = true;
+                        result[i] = YELLOW;
+                        break;
+                    }
+
+    return r;
+}
+
+// encode a result as a base-3 code in [0, N_PATTERNS)
+template <uint8_t L>
+inline Code<L> encode(const Results result[L])
+{
+    uint32_t code = 0;
+    for (uint8_t i = L; i > 0; --i)
+        code = code * 3 + result[i - 1];
+    return (Code<L>)code;
+}
+
+// decode a base-3 result code
+template <uint8_t L>
+inline void decode(Results result[L], uint32_t code)
+{
+    for (uint8_t i = 0; i < L; ++i, code /= 3)
+        result[i] = (Results)(code % 3);
+}
+
+// get the precomputed result of guess against answer
+template <uint8_t L>
+inline Code<L> get_pattern(uint16_t guess, uint16_t answer)
+{
+    return PATTERNS<L>[(size_t)guess * N_VALID + answer];
+}
+
+// compute the result codes of a guess against every answer
+template <uint8_t L>
+void play_all_scalar(Code<L> *codes, const char *guess)
+{
+    Results result[L];
+    for (uint16_t j = 0; j < N_VALID; ++j)
+    {
+        play<L>(result, guess, get_valid_word(j));
+        codes[j] = encode<L>(result);
+    }
+}
+
+#if defined(__x86_64__)
+// as play_all_scalar, but for N_LANES answers at a time from ANSWER_LETTERS
+// follows play() exactly: each non-green letter of the guess marks the first unused matching letter of the
+// answer
+template <uint8_t L>
+__attribute__((target("avx2"))) void play_all_avx2(Code<L> *codes, const char *guess)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+
+    for (uint32_t k = 0; k < N_PADDED; k += N_LANES)
+    {
+        __m256i hidden[L], green[L], done[L], digit[L];
+
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            hidden[i] = _mm256_loadu_si256((const __m256i *)&ANSWER_LETTERS<L>[i][k]);
+            done[i] = green[i] = _mm256_cmpeq_epi8(hidden[i], _mm256_set1_epi8(guess[i]));
+        }
+
+        for (uint8_t i = 0; i < L; ++i)
+        {
+            const __m256i letter = _mm256_set1_epi8(guess[i]);
+            __m256i found = green[i];  // greens never become yellow
+            for (uint8_t j = 0; j < L; ++j)
+            {
+                const __m256i used = _mm256_or_si256(done[j], found);
+                const __m256i match = _mm256_andnot_si256(used, _mm256_cmpeq_epi8(hidden[j], letter));
+                done[j] = _mm256_or_si256(done[j], match);
+                found = _mm256_or_si256(found, match);
+            }
+
+            const __m256i yellow = _mm256_andnot_si256(green[i], found);
+            digit[i] = _mm256_or_si256(_mm256_and_si256(green[i], two), _mm256_and_si256(yellow, one));
+        }
+
+        // base-3 digits of the first five letters fit in one byte, the rest in another
+        __m256i low = zero, high = zero;
+        for (uint8_t i = L; i > 0; --i)
+        {
+            __m256i &part = (i > 5) ? high : low;
+            part = _mm256_add_epi8(_mm256_add_epi8(part, part), _mm256_add_epi8(part, digit[i - 1]));
+        }
+
+        Code<L> last[N_LANES];
+        Code<L> *out = (k + N_LANES <= N_VALID) ? &codes[k] : last;
+        if constexpr (sizeof(Code<L>) == 1)
+            _mm256_storeu_si256((__m256i *)out, low);
+        else
+        {
+            // widen to 16 bits and combine as low + 243 * high, 16 answers at a time
+            const __m256i scale = _mm256_set1_epi16(243);
+            const __m128i halves[2][2] = {
+                {_mm256_castsi256_si128(low), _mm256_castsi256_si128(high)},
+                {_mm256_extracti128_si256(low, 1), _mm256_extracti128_si256(high, 1)}};
+            for (uint8_t h = 0; h < 2; ++h)
+            {
+                const __m256i code = _mm256_add_epi16(
+                    _mm256_cvtepu8_epi16(halves[h][0]),
+                    _mm256_mullo_epi16(_mm256_cvtepu8_epi16(halves[h][1]), scale));
+                _mm256_storeu_si256((__m256i *)&out[16 * h], code);
+            }
+        }
+
+        if (out == last)
+            memcpy(&codes[k], last, (size_t)(N_VALID - k) * sizeof(Code<L>));
+    }
+}
+#endif
+
+// result kernel for this machine, selected at startup
+template <uint8_t L>
+static void (*const PLAY_ALL)(Code<L> *codes, const char *guess) =
+#if defined(__x86_64__)
+    __builtin_cpu_supports("avx2") ? play_all_avx2<L> :
+#endif
+                                   play_all_scalar<L>;
+
+// remove answers which would not have given this result for the guess
+// the state masks remove most answers, the rest are checked against the exact result
+template <uint8_t L>
+void filter_answers(AnswerSet &answers, const State<L> &state, uint16_t guess, uint32_t code)
+{
+    state.valid_answers(answers);
+    answers.for_each(
+        [&](uint16_t answer)
+        {
+            if (get_pattern<L>(guess, answer) != code)
+                answers.reset(answer);
+        });
+}
+
+template <uint8_t L>
+void print_move(std::ostream &out, Results result[L], const char *guess, const char *hidden = nullptr)
+{
+    for (uint8_t i = 0; i < L; ++i)
+        out << COLOR[result[i]] << guess[i];
+
+    out << RST;
+    if (hidden)
+    {
+        out << " / ";
+        for (uint8_t i = 0; i < L; ++i)
+            out << hidden[i];
+    }
+}
+
+// guess cache which can be shared between concurrent searches
+// the best guess depends only on the answers remaining, so it is keyed by their fingerprint, and states
+// reached along different paths which leave the same answers share an entry
+using GuessCache = FlatCache<Fingerprint, uint16_t, FingerprintHash>;
+
+// cost of a bucket of each size, summed over the buckets of a guess and indexed by size
+// EXPECTED and MINIMAX use size^2, as every answer in a bucket of `size` leaves `size` answers remaining
+// ENTROPY uses size * log2(size) in 32.32 fixed point, so that sums are exact and the least sum has the most
+// information
+template <Strategy S>
+static std::vector<uint64_t> BUCKET_COST;
+
+// increase in cost as a bucket grows to each size
+template <Strategy S>
+static std::vector<uint64_t> BUCKET_STEP;
+
+template <Strategy S>
+void init_bucket_cost()
+{
+    BUCKET_COST<S>.resize(N_VALID + 1);
+    BUCKET_STEP<S>.resize(N_VALID + 1);
+    for (uint64_t size = 0; size <= N_VALID; ++size)
+    {
+        if constexpr (S == ENTROPY)
+            BUCKET_COST<S>[size] = (size) ? (uint64_t)llround((double)size * log2((double)size) * 0x1p32) : 0;
+        else
+            BUCKET_COST<S>[size] = size * size;
+        BUCKET_STEP<S>[size] = (size) ? BUCKET_COST<S>[size] - BUCKET_COST<S>[size - 1] : 0;
+    }
+}
+
+template <Strategy S>
+struct Guess
+{
+    uint32_t max{U32MAX};
+    uint64_t cost{U64MAX};
+    uint32_t best{U32MAX};
+    uint16_t word{0};
+
+    bool operator<(const Guess &other) const
+    {
+        constexpr bool MINMAX = S == MINIMAX;
+        if (MINMAX and max < other.max)
+            return true;
+        if (MINMAX and max > other.max)
+            return false;
+
+        if (cost < other.cost)
+            return true;
+        if (cost > other.cost)
+            return false;
+
+        if (MINMAX and best < other.best)
+            return true;
+        if (MINMAX and best > other.best)
+            return false;
+
+        return word < other.word;
+    }
+
+    void add_bucket(uint32_t size)
+    {
+        cost += BUCKET_COST<S>[size];
+        if constexpr (S == MINIMAX)
+        {
+            max = std::max(size, max);
+            best = std::min(size, best);
+        }
+    }
+
+    // whether a guess can be skipped once one of its buckets reaches `size`, given the cost so far
+    // bucket costs only grow as answers are added, so the cost so far is a lower bound
+    bool prune(uint32_t size, uint64_t partial) const
+    {
+        if constexpr (S == MINIMAX)
+            return size > max;
+        else
+            return partial > cost;
+    }
+};
+
+// persistent guess cache file
+// header, followed by `count` entries sorted by key
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t config;    // solver settings the entries were computed with
+    uint64_t checksum;  // checksum of the word lists
+    uint64_t count;     // number of entries
+};
+
+// padded explicitly, so no uninitialized bytes are written to the file
+struct CacheEntry
+{
+    Fingerprint key;
+    uint16_t word;
+    uint16_t padding[3];
+};
+static_assert(sizeof(CacheEntry) == sizeof(Fingerprint) + 4 * sizeof(uint16_t),
+              "CacheEntry has hidden padding");
+
+#define CACHE_FILE "wordle_cache"  // prefix of the cache file name
+#define CACHE_MAGIC "WORDLE\0"
+#define CACHE_VERSION 4u
+#define CACHE_CONFIG (uint32_t)(STRATEGY | HARD << 4 | L << 8)
+
+static uint64_t WORDS_CHECKSUM;  // checksum of the word lists
+
+// cache file for these word lists and settings, so runs with others keep their own warm caches
+template <uint8_t L>
+std::string cache_file()
+{
+    char name[64];
+    snprintf(name, sizeof(name), CACHE_FILE "-%016llx-%04x", (unsigned long long)WORDS_CHECKSUM,
+             CACHE_CONFIG);
+    return name;
+}
+
+static const CacheEntry *FILE_CACHE = nullptr;  // memory mapped entries from the cache file
+static uint64_t FILE_CACHE_SIZE = 0;            // number of mapped entries
+
+// best guesses computed by this run
+static GuessCache guess_cache;
+static std::atomic<bool> CACHE_DIRTY{false};
+
+// map the cache file, ignoring it if it is missing or stale
+template <uint8_t L>
+void load_cache()
+{
+    const std::string file = cache_file<L>();
+    size_t size;
+    char *data = map(file.c_str(), &size);
+    if (not data)
+        return;
+
+    const auto *header = (const CacheHeader *)data;
+    if (size < sizeof(CacheHeader)                                   //
+        or memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic))  //
+        or header->version != CACHE_VERSION                           //
+        or header->config != CACHE_CONFIG                             //
+        or header->checksum != WORDS_CHECKSUM                         //
+        or size != sizeof(CacheHeader) + header->count * sizeof(CacheEntry))
+    {
+        std::cerr << "Ignoring stale cache file " << file << std::endl;
+        munmap(data, size);
+        return;
+    }
+
+    // lookups binary search the keys and play the words, so both must be valid
+    const auto *entries = (const CacheEntry *)(data + sizeof(CacheHeader));
+    for (uint64_t i = 0; i < header->count; ++i)
+        if (entries[i].word >= N_WORDS or (i and entries[i].key < entries[i - 1].key))
+        {
+            std::cerr << "Ignoring corrupt cache file " << file << std::endl;
+            munmap(data, size);
+            return;
+        }
+
+    FILE_CACHE = entries;
+    FILE_CACHE_SIZE = header->count;
+}
+
+// write the mapped and newly computed entries back to the cache file
+template <uint8_t L>
+void save_cache()
+{
+    if (not CACHE_DIRTY)
+        return;
+
+    std::vector<CacheEntry> entries(FILE_CACHE, FILE_CACHE + FILE_CACHE_SIZE);
+    guess_cache.for_each([&](const Fingerprint &key, uint16_t word) { entries.push_back({key, word, {}}); });
+
+    std::sort(entries.begin(), entries.end(),
+              [](const CacheEntry &a, const CacheEntry &b) { return a.key < b.key; });
+
+    CacheHeader header = {CACHE_MAGIC, CACHE_VERSION, CACHE_CONFIG, WORDS_CHECKSUM, entries.size()};
+
+    // write to a temporary and rename, so concurrent runs never see a partial file
+    const std::string file = cache_file<L>();
+    const std::string temp = file + ".tmp." + std::to_string(getpid());
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (not f)
+        return;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok &= fwrite(entries.data(), sizeof(CacheEntry), entries.size(), f) == entries.size();
+    ok &= fclose(f) == 0;
+
+    if (not ok or rename(temp.c_str(), file.c_str()))
+        remove(temp.c_str());
+}
+
+// lookup the best guess for a key in the cache, returns false if not present
+bool lookup_cache(const Fingerprint &key, uint16_t &word)
+{
+    if (guess_cache.find(key, word))
+        return true;
+
+    const CacheEntry *end = FILE_CACHE + FILE_CACHE_SIZE;
+    const CacheEntry *entry = std::lower_bound(
+        FILE_CACHE, end, key, [](const CacheEntry &a, const Fingerprint &b) { return a.key < b; });
+    if (entry != end and entry->key == key)
+    {
+        word = entry->word;
+        return true;
+    }
+
+    return false;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// best of the candidate guesses for the answers under strategy S
+// candidates left once the deadline passes or `cancel` is set are skipped, and `complete` is set to whether
+// none were
+// ties are broken by index, so the order of the candidates only matters if some are skipped
+template <uint8_t L, Strategy S>
+uint16_t best_guess(const std::vector<uint16_t> &answers,
+                    const std::vector<uint16_t> &candidates = ALL_GUESSES,
+                    Clock::time_point deadline = Clock::time_point::max(), bool *complete = nullptr,
+                    const std::atomic<bool> *cancel = nullptr)
+{
+    std::vector<Guess<S>> guesses(POOL.size());
+    const bool timed = deadline != Clock::time_point::max();
+    std::atomic<bool> expired{false};
+
+    POOL.parallel_for((uint32_t)candidates.size(), 64,
+                      [&](unsigned id, uint32_t start, uint32_t end)
+                      {
+                          const uint64_t *bucket_step = BUCKET_STEP<S>.data();
+                          uint16_t counts[N_PATTERNS<L>] = {};
+                          uint32_t evaluated = 0, pruned_count = 0;
+                          for (uint32_t c = start; c < end; ++c)
+                          {
+                              // check the clock and cancel every 64 guesses, always scoring the first
+                              if ((timed or cancel) and c and c % 64 == 0 and
+                                  (expired or (cancel and *cancel) or (timed and Clock::now() > deadline)))
+                              {
+                                  expired = true;
+                                  break;
+                              }
+
+                              const uint16_t i = candidates[c];
+
+                              // histogram of results over remaining answers
+                              const Code<L> *row = &PATTERNS<L>[(size_t)i * N_VALID];
+
+                              size_t n = 0;
+                              uint64_t partial = 0;
+                              bool pruned = false;
+                              for (; n < answers.size(); ++n)
+                              {
+                                  const uint16_t count = ++counts[row[answers[n]]];
+                                  if constexpr (S != MINIMAX)
+                                      partial += bucket_step[count];
+                                  if (guesses[id].prune(count, partial))
+                                  {
+                                      pruned = true;
+                                      ++n;
+                                      break;
+                                  }
+                              }
+
+                              // clear the buckets for the next guess, visiting whichever of the answers
+                              // counted or the buckets is shorter
+                              // buckets are scored as they are cleared
+                              Guess<S> score = {0, 0, U32MAX, i};
+                              if (n < N_PATTERNS<L>)
+                                  for (size_t k = 0; k < n; ++k)
+                                  {
+                                      uint16_t &count = counts[row[answers[k]]];
+                                      if (count and not pruned)
+                                          score.add_bucket(count);
+                                      count = 0;
+                                  }
+                              else
+                                  for (uint16_t j = 0; j < N_PATTERNS<L>; ++j)
+                                  {
+                                      if (counts[j] and not pruned)
+                                          score.add_bucket(counts[j]);
+                                      counts[j] = 0;
+                                  }
+
+                              if (pruned)
+                              {
+                                  ++pruned_count;
+                                  continue;
+                              }
+
+                              ++evaluated;
+                              if (score < guesses[id])
+                                  guesses[id] = score;
+                          }
+
+                          STATS.candidates_evaluated.add(evaluated);
+                          STATS.candidates_pruned.add(pruned_count);
+                      });
+
+    for (unsigned i = 1; i < guesses.size(); ++i)
+        if (guesses[i] < guesses[0])
+            guesses[0] = guesses[i];
+
+    if (complete)
+        *complete = not expired;
+    return guesses[0].word;
+}
+
+// candidates ordered by how evenly their letters split the answers, a cheap guide to which score best
+// each distinct letter adds f * (n - f) for the f answers containing it, and each position the same for the
+// answers with that letter there
+template <uint8_t L>
+std::vector<uint16_t> rank_candidates(const std::vector<uint16_t> &answers,
+                                      const std::vector<uint16_t> &candidates)
+{
+    const uint64_t n = answers.size();
+    uint64_t with[26] = {}, at[L][26] = {};
+    for (const auto &answer : answers)
+    {
+        for (uint32_t m = MASKED_ANSWERS_WHOLE[answer]; m; m &= m - 1)
+            ++with[__builtin_ctz(m)];
+        for (uint8_t k = 0; k < L; ++k)
+            ++at[k][ANSWER_LETTERS<L>[k][answer] - 'a'];
+    }
+
+    // highest score first, then by index
+    std::vector<std::pair<uint64_t, uint16_t>> scored;
+    scored.reserve(candidates.size());
+    for (const auto &i : candidates)
+    {
+        const char *word = get_word(i);
+        uint64_t score = 0;
+        for (uint32_t m = MASKED_WORDS_WHOLE[i]; m; m &= m - 1)
+            score += with[__builtin_ctz(m)] * (n - with[__builtin_ctz(m)]);
+        for (uint8_t k = 0; k < L; ++k)
+            score += at[k][word[k] - 'a'] * (n - at[k][word[k] - 'a']);
+        scored.push_back({U64MAX - score, i});
+    }
+    std::sort(scored.begin(), scored.end());
+
+    std::vector<uint16_t> ranked;
+    ranked.reserve(scored.size());
+    for (const auto &[score, i] : scored)
+        ranked.push_back(i);
+    return ranked;
+}
+
+// guess cache key of the remaining answers
+// in hard mode the guesses allowed also depend on the state, so it is part of the key
+template <uint8_t L>
+Fingerprint guess_key(const State<L> &state, const AnswerSet &remaining)
+{
+    Fingerprint key = remaining.fingerprint();
+    if (HARD)
+    {
+        key.lo = hash_words(state.valid.data(), L, key.lo ^ state.include);
+        key.hi = mix64(key.hi ^ key.lo);
+    }
+    return key;
+}
+
+// best guess for the remaining answers if it is known without searching, as the last answer or from the cache
+template <uint8_t L>
+bool known_guess(const State<L> &state, const AnswerSet &remaining, uint16_t &word)
+{
+    if (remaining.count() == 1)
+    {
+        word = ANSWER_GUESS[remaining.first()];
+        return true;
+    }
+
+    if (not lookup_cache(guess_key(state, remaining), word))
+        return false;
+
+    STATS.cache_hits.add();
+    return true;
+}
+
+// best guess for the remaining answers
+// with a deadline, candidates are scored in the order of rank_candidates until deadline_ms has passed, and
+// `proven` is set to whether every candidate was scored, in which case the guess is the same as without one
+// setting `cancel` stops the search within 64 candidates, and its guess is neither proven nor cached
+template <uint8_t L>
+uint16_t find_guess(const State<L> &state, const AnswerSet &remaining, bool *proven = nullptr,
+                    uint32_t deadline_ms = DEADLINE_MS, const std::atomic<bool> *cancel = nullptr)
+{
+    const Clock::time_point start = Clock::now();
+    if (proven)
+        *proven = true;
+
+    if (remaining.count() == 1)  // only one word left
+        return ANSWER_GUESS[remaining.first()];
+
+    // lookup result from cache if the best play for these answers was already computed
+    const Fingerprint key = guess_key(state, remaining);
+    uint16_t cached;
+    if (lookup_cache(key, cached))
+    {
+        STATS.cache_hits.add();
+        return cached;
+    }
+
+    STATS.cache_misses.add();
+
+    std::vector<uint16_t> answers;
+    answers.reserve(N_VALID);
+    remaining.for_each([&](uint16_t answer) { answers.push_back(answer); });
+
+    std::vector<uint16_t> legal;
+    if (HARD)
+        legal = state.legal_guesses();
+    const std::vector<uint16_t> &allowed = (HARD) ? legal : ALL_GUESSES;
+
+    Clock::time_point deadline = Clock::time_point::max();
+    std::vector<uint16_t> ranked;
+    if (deadline_ms)
+    {
+        deadline = start + std::chrono::milliseconds(deadline_ms);
+        ranked = rank_candidates<L>(answers, allowed);
+    }
+    const std::vector<uint16_t> &candidates = (deadline_ms) ? ranked : allowed;
+
+    uint16_t word = 0;
+    bool complete = true;
+    switch (STRATEGY)
+    {
+        case EXPECTED:
+            word = best_guess<L, EXPECTED>(answers, candidates, deadline, &complete, cancel);
+            break;
+        case MINIMAX:
+            word = best_guess<L, MINIMAX>(answers, candidates, deadline, &complete, cancel);
+            break;
+        case ENTROPY:
+            word = best_guess<L, ENTROPY>(answers, candidates, deadline, &complete, cancel);
+            break;
+    }
+
+    if (proven)
+        *proven = complete;
+
+    // only the best guess is cached, so a later search with more time can still find it
+    if (not complete)
+    {
+        if (not(cancel and *cancel))
+            STATS.searches_timed_out.add();
+        return word;
+    }
+
+    guess_cache.insert(key, word);
+    CACHE_DIRTY = true;
+    return word;
+}
+
+// compute the result code of every guess against every answer
+template <uint8_t L>
+void populate_patterns()
+{
+    POOL.parallel_for(N_WORDS, 64,
+                      [](unsigned, uint32_t start, uint32_t end)
+                      {
+                          for (uint16_t i = (uint16_t)start; i < end; ++i)
+                              PLAY_ALL<L>(&PATTERNS<L>[(size_t)i * N_VALID], get_word(i));
+                      });
+}
+
+// play a game against every answer in parallel, then print the traces in order
+// returns the average number of guesses
+template <uint8_t L>
+float evaluate(bool verbose = true)
+{
+    const State<L> initial;
+    const AnswerSet all = AnswerSet::all();
+
+    // search the first guess across all threads before games start sharing them
+    find_guess(initial, all);
+
+    std::vector<std::string> traces(N_VALID);
+    std::vector<uint8_t> guesses(N_VALID);
+
+    POOL.parallel_for(N_VALID, 8,
+                      [&](unsigned, uint32_t start, uint32_t end)
+                      {
+                          Results result[L];
+                          for (uint16_t i = (uint16_t)start; i < end; ++i)
+                          {
+                              State<L> state = initial;
+                              AnswerSet answers = all;
+                              std::ostringstream out;
+
+                              int j = 0;
+                              bool r = true;
+                              for (; j < 6 and r; ++j)
+                              {
+                                  const uint16_t index = find_guess(state, answers);
+                                  const uint32_t code = get_pattern<L>(index, i);
+                                  const char *guess = get_word(index);
+
+                                  r = code != WIN<L>;
+                                  decode<L>(result, code);
+                                  print_move<L>(out, result, guess);
+                                  out << " ";
+
+                                  state.apply(result, guess);
+                                  filter_answers(answers, state, index, code);
+                              }
+
+                              j += r;
+
+                              if (not r)
+                                  out << j;
+                              else
+                                  out.write(get_valid_word(i), L);
+
+                              if (verbose)
+                                  traces[i] = out.str();
+                              guesses[i] = (uint8_t)j;
+                          }
+                      });
+
+    float avg = 0;
+    uint16_t totals[7] = {};
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        if (verbose)
+            std::cout << traces[i] << std::endl;
+        totals[guesses[i] - 1]++;
+        avg += (float)guesses[i];
+    }
+
+    avg /= (float)N_VALID;
+    if (verbose)
+    {
+        for (uint8_t i = 0; i < 7; ++i)
+            std::cout << totals[i] << " ";
+        std::cout << "Avg: " << avg << std::endl;
+    }
+
+    return avg;
+}
+
+// print the search statistics as JSON, along with those of the named cache tables
+void print_stats(std::ostream &out, const std::vector<std::pair<const char *, CacheStats>> &tables = {})
+{
+    if (not STATS_ENABLED)
+    {
+        out << "Statistics are not collected in this build, configure with -DSOLVER_STATS=ON" << std::endl;
+        return;
+    }
+
+    const uint64_t hits = STATS.cache_hits.get(), misses = STATS.cache_misses.get();
+    const uint64_t evaluated = STATS.candidates_evaluated.get(), pruned = STATS.candidates_pruned.get();
+
+    out << "{\n  \"cache\": {\"hits\": " << hits << ", \"misses\": " << misses
+        << ", \"hit_rate\": " << (double)hits / (double)std::max<uint64_t>(hits + misses, 1) << "},\n";
+    out << "  \"search\": {\"candidates_evaluated\": " << evaluated << ", \"candidates_pruned\": " << pruned
+        << ", \"prune_rate\": " << (double)pruned / (double)std::max<uint64_t>(evaluated + pruned, 1)
+        << ", \"timed_out\": " << STATS.searches_timed_out.get()
+        << ", \"speculated\": " << STATS.speculated.get() << "},\n";
+
+    out << "  \"tables\": {";
+    for (const auto &[name, t] : tables)
+        out << ((&name == &tables[0].first) ? "" : ", ") << "\"" << name << "\": {\"entries\": " << t.entries
+            << ", \"slots\": " << t.slots << ", \"hits\": " << t.hits << ", \"misses\": " << t.misses
+            << ", \"inserts\": " << t.inserts << ", \"evictions\": " << t.evictions << "}";
+    out << "},\n";
+
+    // load imbalance: how far the busiest thread is above the mean, and the fraction of loop time spent idle
+    uint64_t total = 0, most = 0;
+    out << "  \"threads\": [";
+    for (unsigned id = 0; id < POOL.size(); ++id)
+    {
+        const auto &t = POOL.stats()[id];
+        const uint64_t busy = t.busy_ns.get();
+        total += busy;
+        most = std::max(most, busy);
+        out << ((id) ? ", " : "") << "{\"busy_ms\": " << (double)busy / 1e6
+            << ", \"chunks\": " << t.chunks.get() << "}";
+    }
+
+    const double mean = (double)total / POOL.size();
+    const uint64_t loop_ns = POOL.loop_ns.get();
+    const double idle = (loop_ns) ? 1 - (double)total / ((double)loop_ns * POOL.size()) : 0.;
+    out << "],\n  \"parallel_loops\": " << POOL.loops.get() << ", \"loop_ms\": " << (double)loop_ns / 1e6
+        << ", \"imbalance\": " << ((total) ? (double)most / mean - 1 : 0.) << ", \"idle_fraction\": " << idle
+        << "\n}" << std::endl;
+}
+
+// map the word lists and find their sizes and checksum, which is all a decision tree needs
+// returns false if either list cannot be used
+template <uint8_t L>
+bool load_word_lists(const char *valid_file = "words_hidden", const char *words_file = "words_all")
+{
+    if (not load_words(valid_file, VALID_WORDS, L) or not load_words(words_file, WORDS, L))
+        return false;
+
+    N_VALID = VALID_WORDS.size;
+    N_WORDS = WORDS.size;
+    N_BLOCKS = (uint16_t)((N_VALID + 63) / 64);
+    N_PADDED = (N_VALID + N_LANES - 1) / N_LANES * N_LANES;
+    WORDS_CHECKSUM = checksum(WORDS.data, WORDS.bytes, checksum(VALID_WORDS.data, VALID_WORDS.bytes));
+    return true;
+}
+
+// load the word lists and build all lookup tables
+// returns false if either list cannot be used
+template <uint8_t L>
+bool initialize(const char *valid_file = "words_hidden", const char *words_file = "words_all")
+{
+    // Iniitalize word files
+    if (not load_word_lists<L>(valid_file, words_file))
+        return false;
+
+    // Initialize mask cache
+    for (char c = 'a'; c <= 'z'; ++c)
+        GET_MASK(c) = MASK(c);
+
+    // Initialize answer mask cache
+    MASKED_ANSWERS<L>.assign(N_VALID, {});
+    MASKED_ANSWERS_WHOLE.assign(N_VALID, 0);
+    for (auto &letters : ANSWER_LETTERS<L>)
+        letters.assign(N_PADDED, 0);
+
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        const char *word = get_valid_word(i);
+        for (uint8_t j = 0; j < L; ++j)
+        {
+            MASKED_ANSWERS_WHOLE[i] |= (MASKED_ANSWERS<L>[i][j] = GET_MASK(word[j]));
+            ANSWER_LETTERS<L>[j][i] = (uint8_t)word[j];
+        }
+    }
+
+    // Initialize guess mask cache
+    MASKED_WORDS<L>.assign(N_WORDS, {});
+    MASKED_WORDS_WHOLE.assign(N_WORDS, 0);
+    for (uint16_t i = 0; i < N_WORDS; ++i)
+    {
+        const char *word = get_word(i);
+        for (uint8_t j = 0; j < L; ++j)
+            MASKED_WORDS_WHOLE[i] |= (MASKED_WORDS<L>[i][j] = GET_MASK(word[j]));
+    }
+
+    ALL_GUESSES.resize(N_WORDS);
+    std::iota(ALL_GUESSES.begin(), ALL_GUESSES.end(), 0);
+
+    // Initialize answer set index
+    for (auto &sets : ANSWERS_AT<L>)
+        for (auto &set : sets)
+            set = AnswerSet();
+    for (auto &set : ANSWERS_WITH)
+        set = AnswerSet();
+
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        const char *word = get_valid_word(i);
+        for (uint8_t j = 0; j < L; ++j)
+        {
+            ANSWERS_AT<L>[j][word[j] - 'a'].set(i);
+            ANSWERS_WITH[word[j] - 'a'].set(i);
+        }
+    }
+
+    // Find each answer in the guess list
+    std::unordered_map<std::string_view, uint16_t> guess_index;
+    for (uint16_t i = 0; i < N_WORDS; ++i)
+        guess_index.emplace(std::string_view(get_word(i), L), i);
+
+    ANSWER_GUESS.resize(N_VALID);
+    for (uint16_t i = 0; i < N_VALID; ++i)
+    {
+        const auto &it = guess_index.find(std::string_view(get_valid_word(i), L));
+        if (it == guess_index.end())
+        {
+            std::cerr << valid_file << ":" << i + 1 << ": answer is not in " << words_file << std::endl;
+            return false;
+        }
+
+        ANSWER_GUESS[i] = it->second;
+    }
+
+    // Initialize guess scoring
+    init_bucket_cost<EXPECTED>();
+    init_bucket_cost<MINIMAX>();
+    init_bucket_cost<ENTROPY>();
+
+    // Initialize result cache
+    PATTERNS<L>.resize((size_t)N_WORDS * N_VALID);
+    populate_patterns<L>();
+
+    return true;
+}